@@ -20,67 +20,72 @@
 #include "ttable.hh"
 #include "threadtunnel.hh"
 #include "util.hh"
-#include "mainapp.hh"
+#include "profile.hh"
 
 #include <stdlib.h>
+#include <stdio.h>
 #include <iostream>
 #include <sstream>
-#include <sys/time.h>
+#include <algorithm>
 #include <math.h>
 
 #define RANDOMIZE true
 #define LOGSEARCH false
 #define ALGOTRACE 0
 
-const PlayerIF_AlgoAB::eval_t VALUE_INFINITE = 10000;
-const PlayerIF_AlgoAB::eval_t EVAL_WIN = 9000;
+// material, freedom, mills, experience
+static const float defaultWeight[PlayerIF_AlgoAB::Weight_NWEIGHTS] = { 1.0, 0.2, 0.8, 1.0 };
 
-inline void addPly(PlayerIF_AlgoAB::eval_t &e)
+PlayerIF_AlgoAB::PlayerIF_AlgoAB()
+    : m_tunnel(NULL),
+    thread(NULL)
 {
-    /**/ if (e > EVAL_WIN)
-        e--;
-    else if (e < -EVAL_WIN)
-        e++;
+    moveCnt = 0;
+
+    m_maxDepth = 25;
+    m_maxNodes = 0;
+    m_searchStrategy = Search_MakeUnmake;
+    m_symmetricTT = false;
+    m_activeNetwork = NULL;
+    m_deterministic = false;
+    m_randomSeed = 0;
+    m_multiPV = 1;
+
+    for (int w = 0; w < Weight_NWEIGHTS; w++) {
+        m_weight[w] = defaultWeight[w];
+    }
+
+    m_score = 0;
+
+    g_mutex_init(&m_threadMutex);
+    g_mutex_init(&m_registerMutex);
 }
 
-inline void subPly(PlayerIF_AlgoAB::eval_t &e)
+PlayerIF_AlgoAB::~PlayerIF_AlgoAB()
 {
-    /**/ if (e > EVAL_WIN)
-        e++;
-    else if (e < -EVAL_WIN)
-        e--;
+    g_mutex_clear(&m_threadMutex);
+    g_mutex_clear(&m_registerMutex);
 }
 
-int nPlysUntilEnd(PlayerIF_AlgoAB::eval_t e)
+void PlayerIF_AlgoAB::registerTTable(ttable_ptr tt)
 {
-    e = fabs(e);
-    return VALUE_INFINITE - e;
+    g_mutex_lock(&m_registerMutex);
+    m_registeredTTable = tt;
+    g_mutex_unlock(&m_registerMutex);
 }
 
-static int timeDiff_ms(const struct timeval &t1,
-                       const struct timeval &t2)
+void PlayerIF_AlgoAB::registerNetwork(nnue_ptr n)
 {
-    const int diffSec = t2.tv_sec - t1.tv_sec;
-    const int diffUS = t2.tv_usec - t1.tv_usec;
-
-    const int diffMS = diffSec * 1000 + diffUS / 1000;
-
-    return diffMS;
+    g_mutex_lock(&m_registerMutex);
+    m_registeredNetwork = n;
+    g_mutex_unlock(&m_registerMutex);
 }
 
-PlayerIF_AlgoAB::PlayerIF_AlgoAB()
-    : m_tunnel(NULL),
-    thread(NULL)
+void PlayerIF_AlgoAB::registerAnalysisCache(analysiscache_ptr c)
 {
-    moveCnt = 0;
-
-    m_maxMSecs = 1000;
-    m_maxDepth = 25;
-
-    m_weight[Weight_Material] = 1.0;
-    m_weight[Weight_Freedom] = 0.2;
-    m_weight[Weight_Mills] = 0.8;
-    m_weight[Weight_Experience] = 1.0;
+    g_mutex_lock(&m_registerMutex);
+    m_registeredAnalysisCache = c;
+    g_mutex_unlock(&m_registerMutex);
 }
 
 void PlayerIF_AlgoAB::resetGame()
@@ -88,7 +93,11 @@ void PlayerIF_AlgoAB::resetGame()
     /* We have to clear the t-table to prevent that
         the computer always plays the same game. */
 
-    m_ttable->clear();
+    g_mutex_lock(&m_registerMutex);
+    ttable_ptr tt = m_registeredTTable;
+    g_mutex_unlock(&m_registerMutex);
+
+    tt->newGeneration();
 }
 
 void startSearchThread(class PlayerIF_AlgoAB *);
@@ -111,7 +120,9 @@ void PlayerIF_AlgoAB::startMove(const Position &curr, int moveID)
     rootPos = curr;
     m_moveID = moveID;
 
+    g_mutex_lock(&m_threadMutex);
     thread = g_thread_new(NULL, (GThreadFunc)startSearchThread, this);
+    g_mutex_unlock(&m_threadMutex);
 }
 
 // kicker
@@ -122,43 +133,278 @@ void startSearchThread(class PlayerIF_AlgoAB *algo)
 
 void PlayerIF_AlgoAB::doSearch()
 {
-    gettimeofday(&m_startTime, NULL);
+    m_timeMgr.startMove();
+
+    /* From here on, the search only uses its own references to the table, the network, and
+       the analysis cache. Objects that are registered meanwhile are not freed before the
+       search is over. */
+    g_mutex_lock(&m_registerMutex);
+    m_ttable = m_registeredTTable;
+    m_network = m_registeredNetwork;
+    m_analysisCache = m_registeredAnalysisCache;
+    g_mutex_unlock(&m_registerMutex);
 
     m_move.reset();
     m_ttable->resetStats();
+    m_nodesSearched = 0;
+    m_nodesEvaluated = 0;
+    m_selDepth = 0;
+    m_prevIterationNodes = 0;
+    m_searchInfo = SearchInfo();
+    PROFILE_RESET();
+
+    if (m_deterministic) {
+        m_ttable->newGeneration(); // much cheaper than clear() on large tables
+        m_random.setSeed(m_randomSeed);
+    } else {
+        m_random.setSeed(rand());
+    }
 
-    float e;
+    m_analysis.clear();
+    m_excludedRootMoves.clear();
 
-    for (int depth = 1; depth <= m_maxDepth; depth++) {
-        m_nodesEvaluated = 0;
+    initEvaluation();
+
+    if (m_analysisCache && !m_deterministic) {
+        startFromAnalysisCache();
+    }
+
+    int nLines = 1;
+    if (m_multiPV > 1) {
+        std::vector<Move> moves;
+        m_ruleSpec->generateMoves(moves, rootPos);
+        nLines = std::min(m_multiPV, int(moves.size()));
+    }
+
+    eval_t e;
 
+    for (int depth = 1; depth <= m_maxDepth; depth++) {
         Variation var;
-        e = search(rootPos, -VALUE_INFINITE, VALUE_INFINITE, 0, depth, var, true);
+        e = searchRoot(depth, var);
+
+        m_timeMgr.iterationFinished(depth, m_move, e);
+
+        if (m_analysisCache && !m_deterministic) {
+            AnalysisCache::Result result;
+            result.eval = e;
+            result.depth = depth;
+            result.bestMove = m_move;
+            m_analysisCache->store(*m_ruleSpec, rootPos, result);
+        }
+
+        // search the next-best root moves, excluding the ones found so far
+
+        if (m_multiPV > 1) {
+            std::vector<AnalysisLine> analysis(1);
+            analysis[0].eval = e;
+            analysis[0].pv = var;
+
+            for (int k = 1; k < nLines && !var.empty(); k++) {
+                m_excludedRootMoves.push_back(var[0]);
+
+                var.clear();
+                eval_t eval = searchRoot(depth, var);
+
+                if (!var.empty()) {
+                    analysis.push_back(AnalysisLine());
+                    analysis.back().eval = eval;
+                    analysis.back().pv = var;
+                }
+            }
+
+            m_excludedRootMoves.clear();
+
+            for (size_t k = 0; k < analysis.size(); k++) {
+                if (rootPos.getCurrentPlayer() == PL_Black) {
+                    analysis[k].eval = -analysis[k].eval;
+                }
+            }
+
+            m_analysis = analysis;
+            logAnalysis(m_analysis, depth);
+        }
 
         // normalize evaluation for white
         if (rootPos.getCurrentPlayer() == PL_Black) {
             e = -e;
         }
 
+        m_score = e;
+
+        reportSearchInfo(depth, e);
+
         if (LOGSEARCH)
-            std::cout << "STEP move " << m_move << " depth " << depth << " -> eval=" << e
-            << " nodes evaluated= " << m_nodesEvaluated
-            << "\n";
+            std::cout << "STEP " << m_searchInfo << "\n";
 
-        if (fabs(e) >= EVAL_WIN) {
-            int overInPlys = nPlysUntilEnd(e);
+        if (isMateScore(e)) {
+            int overInPlys = matePlies(e);
 
             if (overInPlys <= depth + 1) {
                 // we won't find a better winning line
                 break;
             }
         }
+
+        // the next iteration would probably not complete within the planned time
+        if (!m_deterministic && !m_timeMgr.mayStartIteration()) {
+            break;
+        }
+
+        if (m_maxNodes && m_nodesSearched >= m_maxNodes) {
+            break;
+        }
     }
 
+    PROFILE_REPORT();
+
     m_tunnel->doMove(m_move, m_moveID);
     installJoinThreadHandler();
 }
 
+/* Insert a previous result for the root position into the transposition table.
+   The iterations up to the cached depth are then answered from the table.
+ */
+void PlayerIF_AlgoAB::startFromAnalysisCache()
+{
+    AnalysisCache::Result result;
+    if (!m_analysisCache->lookup(*m_ruleSpec, rootPos, result)) {
+        return;
+    }
+
+    // protect against ID collisions
+    std::vector<Move> moves;
+    m_ruleSpec->generateMoves(moves, rootPos);
+    if (std::find(moves.begin(), moves.end(), result.bestMove) == moves.end()) {
+        return;
+    }
+
+    int permutationIdx;
+    Key key = ttKey(rootPos, permutationIdx);
+
+    m_ttable->save(key, result.eval, TranspositionTable::BOUND_EXACT,
+                   std::min(result.depth, m_maxDepth), ttMoveFromBoard(result.bestMove, permutationIdx), rootPos);
+}
+
+Key PlayerIF_AlgoAB::ttKey(const Position &pos, int &permutationIdx) const
+{
+    if (!m_symmetricTT) {
+        permutationIdx = -1;
+        return pos.key();
+    }
+
+    return m_ruleSpec->getSymmetricKey(pos, &permutationIdx);
+}
+
+/* The sort key of a move in PlayerIF_AlgoAB::orderMovesByTT(). The score of a child that
+   failed high is only an upper bound for the parent, hence these moves are tried after those
+   with an exact score or a lower bound, and children without an entry come last. Within each
+   class, the moves are sorted by score and then by the depth of the entry. */
+struct TTMoveRank
+{
+    int boundClass; // 0: exact or lower bound, 1: upper bound, 2: no entry
+    int negScore;
+    int negDepth;
+    size_t idx; // keeps ties in order
+    Key childKey;
+
+    bool operator<(const TTMoveRank &r) const
+    {
+        if (boundClass != r.boundClass)
+            return boundClass < r.boundClass;
+        if (negScore != r.negScore)
+            return negScore < r.negScore;
+        if (negDepth != r.negDepth)
+            return negDepth < r.negDepth;
+        return idx < r.idx;
+    }
+};
+
+void PlayerIF_AlgoAB::orderMovesByTT(std::vector<Move> &moves, std::vector<Key> &childKeys, size_t first) const
+{
+    std::vector<TTMoveRank> order(moves.size() - first);
+
+    for (size_t i = first; i < moves.size(); i++) {
+        TTMoveRank &rank = order[i - first];
+        rank.idx = i;
+        rank.childKey = childKeys[i];
+
+        const TranspositionTable::TTEntry *entry = m_ttable->peek(childKeys[i]);
+        if (!entry) {
+            rank.boundClass = 2;
+            rank.negScore = rank.negDepth = 0;
+        } else {
+            rank.boundClass = (entry->getBoundType() == TranspositionTable::BOUND_LOWER ? 1 : 0);
+            rank.negScore = -scoreToParent(entry->value8);
+            rank.negDepth = -entry->depth8;
+        }
+    }
+
+    std::sort(order.begin(), order.end());
+
+    std::vector<Move> sorted(moves.begin(), moves.begin() + first);
+    sorted.reserve(moves.size());
+    for (size_t i = 0; i < order.size(); i++) {
+        sorted.push_back(moves[order[i].idx]);
+        childKeys[first + i] = order[i].childKey;
+    }
+
+    moves.swap(sorted);
+}
+
+Move PlayerIF_AlgoAB::ttMoveToBoard(const Move &m, int permutationIdx) const
+{
+    // the best move is undefined if no move was searched
+    if (permutationIdx < 0 || m.newPos < 0 || m.newPos >= m_ruleSpec->boardSpec->nPositions()) {
+        return m;
+    }
+
+    return permuteMove(m, m_ruleSpec->boardSpec->getInversePermutations()[permutationIdx]);
+}
+
+Move PlayerIF_AlgoAB::ttMoveFromBoard(const Move &m, int permutationIdx) const
+{
+    if (permutationIdx < 0 || m.newPos < 0 || m.newPos >= m_ruleSpec->boardSpec->nPositions()) {
+        return m;
+    }
+
+    return permuteMove(m, m_ruleSpec->boardSpec->getPermutations()[permutationIdx]);
+}
+
+PlayerIF_AlgoAB::eval_t PlayerIF_AlgoAB::searchRoot(int depth, Variation &var)
+{
+    if (m_searchStrategy == Search_CopyMake)
+        return search<Search_CopyMake>(rootPos, -SCORE_INFINITE, SCORE_INFINITE, 0, depth, var, true);
+    else
+        return search<Search_MakeUnmake>(rootPos, -SCORE_INFINITE, SCORE_INFINITE, 0, depth, var, true);
+}
+
+// number of table entries checked to estimate the fill status
+static const int TT_FILL_SAMPLES = 1000;
+
+void PlayerIF_AlgoAB::reportSearchInfo(int depth, eval_t score)
+{
+    SearchInfo info;
+    info.depth = depth;
+    info.selDepth = m_selDepth;
+    info.nodes = m_nodesSearched;
+    info.leafEvals = m_nodesEvaluated;
+    info.timeMS = m_timeMgr.elapsedMS();
+    info.score = score;
+    info.bestMove = m_move;
+
+    info.ttLookups = m_ttable->nLookups();
+    info.ttHits = m_ttable->nHits();
+    info.ttCollisions = m_ttable->nCollisions();
+    info.ttFill = m_ttable->getFillStatus(TT_FILL_SAMPLES);
+
+    const long long iterationNodes = m_nodesSearched - m_searchInfo.nodes;
+    info.branchingFactor = (m_prevIterationNodes > 0 ? float(iterationNodes) / m_prevIterationNodes : 0);
+    m_prevIterationNodes = iterationNodes;
+
+    m_searchInfo = info;
+    m_tunnel->reportSearchInfo(info);
+}
+
 void PlayerIF_AlgoAB::installJoinThreadHandler()
 {
     class IdleFunc_JoinAlgoThread : public IdleFunc
@@ -195,39 +441,39 @@ void PlayerIF_AlgoAB::cancelMove()
 
 void PlayerIF_AlgoAB::joinThread()
 {
-    if (thread) {
-        g_thread_join(thread);
-        thread = NULL;
+    g_mutex_lock(&m_threadMutex);
+    GThread *t = thread;
+    thread = NULL;
+    g_mutex_unlock(&m_threadMutex);
+
+    if (t) {
+        g_thread_join(t);
     }
 }
 
 inline void PlayerIF_AlgoAB::checkTime()
 {
-    struct timeval endTime;
-    gettimeofday(&endTime, NULL);
-
-    int timeDiffMS = timeDiff_ms(m_startTime, endTime);
+    const int elapsed = m_timeMgr.elapsedMS();
 
     // thinking time is over
-    if (timeDiffMS >= m_maxMSecs) {
+    if (!m_deterministic && m_timeMgr.hardLimitReached(elapsed)) {
         m_stopThread = true;
     }
 
     // update progress bar
-    float perc = timeDiffMS;
-    perc /= m_maxMSecs;
-    if (perc > 1.0)
-        perc = 1.0;
-
-    m_tunnel->setProgress(perc);
+    m_tunnel->setProgress(m_timeMgr.progress(elapsed));
 }
 
 // ----------------------------------------------------------------------------------------------------
 
-#define INDENT std::cout << "-" << (&"| | | | | | | | | | "[20 - currDepth * 2]);
+#define INDENT std::cout << "-" << (&"| | | | | | | | | | "[20 - originDepth * 2]);
 
-float PlayerIF_AlgoAB::search(const Position &pos, float alpha, float beta,
-                               int originDepth, int depth, Variation &variation, bool useTT)
+// minimum remaining depth for ordering the moves by the table entries of the children
+static const int TT_ORDERING_MIN_DEPTH = 3;
+
+template <PlayerIF_AlgoAB::SearchStrategy S>
+PlayerIF_AlgoAB::eval_t PlayerIF_AlgoAB::search(const Position &pos, eval_t alpha, eval_t beta,
+                              int originDepth, int depth, Variation &variation, bool useTT)
 {
     if (ALGOTRACE) {
         INDENT;
@@ -236,14 +482,24 @@ float PlayerIF_AlgoAB::search(const Position &pos, float alpha, float beta,
 
     const bool atRoot = (originDepth == 0);
 
+    if (originDepth > m_selDepth)
+        m_selDepth = originDepth;
+
     // check thinking time and stop if we were thinking too long
 
-    if (depth > 5 || atRoot) {
+    m_nodesSearched++;
+    if (atRoot || (m_nodesSearched & (TimeManager::POLL_INTERVAL - 1)) == 0) {
         if (useTT)
             checkTime();
     }
 
+    if (m_maxNodes && m_nodesSearched >= m_maxNodes) {
+        m_stopThread = true;
+    }
+
     if (m_stopThread && m_computedSomeMove) {
+        PROFILE_REPORT();
+
         if (!m_ignoreMove) {
             m_tunnel->doMove(m_move, m_moveID);
         }
@@ -254,17 +510,28 @@ float PlayerIF_AlgoAB::search(const Position &pos, float alpha, float beta,
     // check winning situations
 
     if (pos.getNPiecesLeft(pos.getCurrentPlayer()) < 3) {
-        return -VALUE_INFINITE;
+        return -SCORE_MATE;
     }
 
     // check transposition-table
 
-    const float oldAlpha = alpha;
+    const eval_t oldAlpha = alpha;
+
+    /* In multi-PV mode, the root entry is only used for move ordering, because
+       we need the complete variations and a table entry does not know about
+       the excluded moves. */
+    const bool rootMultiPV = (atRoot && m_multiPV > 1);
+
+    int ttPermutation;
+    const Key key = ttKey(pos, ttPermutation);
 
     const TranspositionTable::TTEntry *entry = NULL;
+    Move ttMove;
     if (useTT)
-        entry = m_ttable->search(pos.key(), pos);
-    if (entry) {
+        entry = m_ttable->search(key, pos);
+    if (entry)
+        ttMove = ttMoveToBoard(entry->ttMove, ttPermutation);
+    if (entry && !rootMultiPV) {
         if (entry->depth8 >= depth) {
             if (ALGOTRACE) {
                 INDENT;
@@ -273,7 +540,7 @@ float PlayerIF_AlgoAB::search(const Position &pos, float alpha, float beta,
 
             if (entry->getBoundType() == TranspositionTable::BOUND_EXACT) {
                 if (atRoot) {
-                    m_move = entry->ttMove;
+                    m_move = ttMove;
                     m_computedSomeMove = true;
                     logBestMoveFromTable(pos, m_move, entry->value8, entry->depth8);
                 }
@@ -284,14 +551,14 @@ float PlayerIF_AlgoAB::search(const Position &pos, float alpha, float beta,
                 }
                 return entry->value8;
             } else if (entry->getBoundType() == TranspositionTable::BOUND_LOWER) {
-                alpha = std::max(alpha, entry->value8);
+                alpha = std::max(alpha, eval_t(entry->value8));
             } else if (entry->getBoundType() == TranspositionTable::BOUND_UPPER) {
-                beta = std::min(beta, entry->value8);
+                beta = std::min(beta, eval_t(entry->value8));
             }
 
             if (alpha >= beta) {
                 if (atRoot) {
-                    m_move = entry->ttMove;
+                    m_move = ttMove;
                     m_computedSomeMove = true;
                 }
 
@@ -307,16 +574,7 @@ float PlayerIF_AlgoAB::search(const Position &pos, float alpha, float beta,
     // process leaves
 
     if (depth == 0) {
-        float eval = Eval(pos, depth);
-
-        /*
-              float memeval = -m_posMemory.lookupHash(pos);
-              if (memeval!=0)
-            {
-              subPly(memeval);
-              return memeval;
-            }
-              */
+        eval_t eval = Eval(pos, originDepth);
 
         if (ALGOTRACE) {
             INDENT;
@@ -328,10 +586,11 @@ float PlayerIF_AlgoAB::search(const Position &pos, float alpha, float beta,
     // try previous best-move first
 
     Position tmpBoard;
-    float bestEval = -VALUE_INFINITE;
+    eval_t bestEval = -SCORE_INFINITE;
     Move bestMove;
 
-    tmpBoard = pos;
+    if (S == Search_MakeUnmake)
+        tmpBoard = pos;
 
     // recurse
 
@@ -339,29 +598,51 @@ float PlayerIF_AlgoAB::search(const Position &pos, float alpha, float beta,
     moves.reserve(100); // speed-up move generation
     m_ruleSpec->generateMoves(moves, pos);
 
+    if (atRoot) {
+        for (size_t i = 0; i < m_excludedRootMoves.size(); i++) {
+            moves.erase(std::remove(moves.begin(), moves.end(), m_excludedRootMoves[i]), moves.end());
+        }
+    }
+
     if (moves.size() == 0) {
-        return -VALUE_INFINITE;
+        return -SCORE_MATE;
     }
 
     // Move ordering: put most promising move to front
 
+    bool ttMoveFirst = false;
     if (entry) {
-        for (int i = 1; i < moves.size(); i++)
-            if (moves[i] == entry->ttMove) {
+        for (int i = 0; i < moves.size(); i++)
+            if (moves[i] == ttMove) {
                 std::swap(moves[0], moves[i]);
+                ttMoveFirst = true;
                 break;
             }
     }
 
     // random move order to randomize play
-    if (RANDOMIZE && atRoot) {
+    const bool shuffleRoot = (RANDOMIZE && atRoot && (m_randomSeed || !m_deterministic));
+    if (shuffleRoot) {
         for (int i = 1; i < moves.size(); i++) {
-            int idx2 = (rand() % (moves.size() - i)) + i;
+            int idx2 = m_random.nextInt(moves.size() - i) + i;
 
             std::swap(moves[i], moves[idx2]);
         }
     }
 
+    /* Otherwise, look one ply ahead into the table. The child keys are cheap, but the table
+       accesses are not, so this only pays off far enough from the leaves. The keys are kept
+       for prefetching the child entries below. Symmetric keys cannot be derived from the move. */
+    std::vector<Key> childKeys;
+    if (useTT && !m_symmetricTT && depth >= TT_ORDERING_MIN_DEPTH && !shuffleRoot) {
+        childKeys.reserve(moves.size());
+        for (size_t i = 0; i < moves.size(); i++) {
+            childKeys.push_back(pos.keyAfter(moves[i]));
+        }
+
+        orderMovesByTT(moves, childKeys, ttMoveFirst ? 1 : 0);
+    }
+
     if (ALGOTRACE) {
         INDENT;
         std::cout << "list of moves: ";
@@ -377,30 +658,37 @@ float PlayerIF_AlgoAB::search(const Position &pos, float alpha, float beta,
             std::cout << "try move: " << moves[i] << "  (" << alpha << "," << beta << ")\n";
         }
 
-        tmpBoard.doMove(moves[i]);
+        /* The child probes the table first thing. Fetching its entry now overlaps the
+           memory access with making the move. The symmetric key is too expensive to
+           compute twice, so we only prefetch for plain keys. */
+        if (useTT && !m_symmetricTT)
+            m_ttable->prefetch(childKeys.empty() ? pos.keyAfter(moves[i]) : childKeys[i]);
+
+        Position &child = (S == Search_CopyMake ? m_plyStack[originDepth + 1] : tmpBoard);
+        if (S == Search_CopyMake)
+            child = pos;
+
+        if (m_activeNetwork) {
+            m_accStack[originDepth + 1] = m_accStack[originDepth];
+            m_activeNetwork->update(m_accStack[originDepth + 1], pos, moves[i]);
+        }
+
+        child.doMove(moves[i]);
 
         Variation childVar;
-        eval_t recBeta = beta;
-        subPly(recBeta);
-        eval_t recAlpha = alpha;
-        subPly(recAlpha);
-        float eval = -search(tmpBoard, -recBeta, -recAlpha, originDepth + 1, depth - 1, childVar, useTT);
-        addPly(eval);
+        eval_t eval = scoreToParent(search<S>(child, boundToChild(beta), boundToChild(alpha),
+                                              originDepth + 1, depth - 1, childVar, useTT));
 
         if (originDepth == 0 && m_experience != NULL) {
-            if (fabs(eval) < EVAL_WIN) {
-                float offset = m_experience->getOffset(m_ruleSpec->getBoardID_Symmetric(tmpBoard), m_selfPlayer);
+            if (!isMateScore(eval)) {
+                float offset = m_experience->getOffset(m_ruleSpec->getBoardID_Symmetric(child), m_selfPlayer);
                 offset *= m_weight[Weight_Experience];
-                eval += offset;
+                eval = scoreFromPieces(scoreToPieces(eval) + offset);
             }
         }
 
-        /*
-              if (abs(eval)>EVAL_WIN)
-            m_posMemory.storeBoard(tmpBoard,eval);
-              */
-
-        tmpBoard.undoMove(moves[i]);
+        if (S == Search_MakeUnmake)
+            child.undoMove(moves[i]);
 
         if (eval > bestEval) {
             bestEval = eval;
@@ -410,8 +698,9 @@ float PlayerIF_AlgoAB::search(const Position &pos, float alpha, float beta,
             variation.push_back(moves[i]);
             variation.append(childVar);
 
-            if (atRoot) {
-                logBestMove(variation, bestEval, depth);
+            if (atRoot && m_excludedRootMoves.empty()) {
+                if (!rootMultiPV)
+                    logBestMove(variation, bestEval, depth);
                 m_move = bestMove;
                 m_computedSomeMove = true;
             }
@@ -441,9 +730,11 @@ float PlayerIF_AlgoAB::search(const Position &pos, float alpha, float beta,
         }
     }
 
-    // save into transposition-table
-    m_ttable->save(pos.key(), bestEval, TranspositionTable::boundType(bestEval, oldAlpha, beta),
-                     depth, bestMove, pos);
+    // save into transposition-table (not if some root moves were excluded)
+    if (!atRoot || m_excludedRootMoves.empty()) {
+        m_ttable->save(key, bestEval, TranspositionTable::boundType(bestEval, oldAlpha, beta),
+                       depth, ttMoveFromBoard(bestMove, ttPermutation), pos);
+    }
 
     if (ALGOTRACE) {
         INDENT;
@@ -455,77 +746,75 @@ float PlayerIF_AlgoAB::search(const Position &pos, float alpha, float beta,
     return bestEval;
 }
 
-float PlayerIF_AlgoAB::Eval(const Position &pos, int levelsToGo) const
+PlayerIF_AlgoAB::eval_t PlayerIF_AlgoAB::Eval(const Position &pos, int ply) const
 {
-    m_nodesEvaluated++;
-
-    float eval = 0.0;
+    PROFILE(Prof_Eval);
 
-    const Player me = pos.getCurrentPlayer();
-    const Player other = opponent(me);
-
-    const RuleSpec &ruleSpec = *m_ruleSpec;
-    const BoardSpec &boardSpec = *ruleSpec.boardSpec;
-
-    // ========== material ==========
+    m_nodesEvaluated++;
 
-    eval += m_weight[Weight_Material] * (pos.getNPiecesLeft(pos.getCurrentPlayer()) -
-                                         pos.getNPiecesLeft(pos.getOpponentPlayer()));
+    if (m_activeNetwork) {
+        if (m_evaluation.isBlocked(pos)) {
+            return -SCORE_MATE;
+        }
 
-    // ========== freedom ==========
+        return scoreFromPieces(m_activeNetwork->evaluate(m_accStack[ply], pos.getCurrentPlayer()));
+    }
 
-    int myFreedom = 0;
-    int oppFreedom = 0;
-    for (int i = 0; i < boardSpec.nPositions(); i++) {
-        /**/ if (pos.getPosition(i) == me)
-            myFreedom += ruleSpec.freedomAtPosition(pos, i);
-        else if (pos.getPosition(i) == other)
-            oppFreedom += ruleSpec.freedomAtPosition(pos, i);
+    float feature[Term_NTERMS];
+    if (!m_evaluation.features(pos, feature)) {
+        return -SCORE_MATE;
     }
 
-    // Note: consider special case at start of game: no pieces on the pos -> no freedom.
+    const float *weight = m_termWeight[m_evaluation.getPhase(pos)];
 
-    if (myFreedom == 0 &&
-        pos.getNPiecesOnBoard(pos.getCurrentPlayer()) > 0) {
-        if (ruleSpec.mayJump && pos.getNPiecesLeft(pos.getCurrentPlayer()) == 3) {
-        } else if (pos.getNPiecesToSet(pos.getCurrentPlayer()) > 0) {
-        } else {
-            return -VALUE_INFINITE;
-        }
+    float eval = 0.0;
+    for (int t = 0; t < Term_NTERMS; t++) {
+        eval += weight[t] * feature[t];
     }
 
-    eval += m_weight[Weight_Freedom] * (myFreedom - oppFreedom);
+    return scoreFromPieces(eval);
+}
 
-    // ========== mills ==========
+/* The weights of the evaluation terms are taken from the parameter table for the
+   board. The user weights for material, freedom, and mills scale the corresponding
+   terms relative to their default values.
+ */
+void PlayerIF_AlgoAB::initEvaluation()
+{
+    m_evaluation.setRules(m_ruleSpec);
 
-    int myMills = 0;
-    int otherMills = 0;
-    for (int i = 0; i < boardSpec.nMills(); i++) {
-        const MillPosVector &mill = boardSpec.getMill(i);
+    const EvalParams &params = EvalParams::forBoard(m_ruleSpec->boardSpec->getBoardPresetID());
 
-        Player p0 = pos.getPosition(mill[0]);
-        if (p0 != PL_None &&
-            p0 == pos.getPosition(mill[1]) &&
-            p0 == pos.getPosition(mill[2])) {
-            if (p0 == me)
-                myMills++;
-            else
-                otherMills++;
+    for (int phase = 0; phase < Phase_NPHASES; phase++)
+        for (int t = 0; t < Term_NTERMS; t++) {
+            m_termWeight[phase][t] = params.weight[phase][t];
         }
-    }
 
-    eval += m_weight[Weight_Mills] * (myMills - otherMills);
+    const struct
+    {
+        Weight weight;
+        EvalTerm term;
+    } scaledTerms[] =
+    {
+        { Weight_Material, Term_Material },
+        { Weight_Freedom, Term_Freedom },
+        { Weight_Mills, Term_Mills }
+    };
 
-#if 0
-    // dummy weights for debugging ...
+    for (int i = 0; i < 3; i++)
+        for (int phase = 0; phase < Phase_NPHASES; phase++) {
+            m_termWeight[phase][scaledTerms[i].term] *=
+                m_weight[scaledTerms[i].weight] / defaultWeight[scaledTerms[i].weight];
+        }
 
-    for (int i = 0; i < m_control->getBoardSpec().nPositions(); i++) {
-        /**/ if (pos.getPosition(i) == me)    eval += 24 - i;
-        else if (pos.getPosition(i) == other) eval -= 24 - i;
-    }
-#endif
+    // The accumulators are derived from the root position ply by ply (see search()).
 
-    return eval;
+    if (m_network && m_network->getBoardPreset() == m_ruleSpec->boardSpec->getBoardPresetID()) {
+        m_activeNetwork = m_network.get();
+        m_activeNetwork->refresh(m_accStack[0], rootPos);
+    } else {
+        m_activeNetwork = NULL;
+    }
 }
 
 void PlayerIF_AlgoAB::logBestMoveFromTable(const Position &b, const Move &m, eval_t e, int depth) const
@@ -540,10 +829,11 @@ void PlayerIF_AlgoAB::logBestMoveFromTable(const Position &b, const Move &m, eva
 
         pos.doMove(move);
 
+        int permutationIdx;
         const TranspositionTable::TTEntry *entry;
-        entry = m_ttable->search(pos.key(), pos);
+        entry = m_ttable->search(ttKey(pos, permutationIdx), pos);
         if (entry) {
-            move = entry->ttMove;
+            move = ttMoveToBoard(entry->ttMove, permutationIdx);
         } else
             break;
     }
@@ -558,7 +848,7 @@ void PlayerIF_AlgoAB::logBestMove(const Move &m, eval_t e, int depth) const
     logBestMove(v, e, depth);
 }
 
-void PlayerIF_AlgoAB::logBestMove(const Variation &v, eval_t e, int depth, const char *suffix) const
+std::string PlayerIF_AlgoAB::formatVariation(const Variation &v, eval_t e) const
 {
     std::stringstream strstr;
 
@@ -571,8 +861,7 @@ void PlayerIF_AlgoAB::logBestMove(const Variation &v, eval_t e, int depth, const
     }
 
     strstr << "(";
-    if (fabs(e) > EVAL_WIN) {
-        strstr << e << " ";
+    if (isMateScore(e)) {
 
         Player winner;
         if (rootPos.getCurrentPlayer() == PL_White)
@@ -588,11 +877,7 @@ void PlayerIF_AlgoAB::logBestMove(const Variation &v, eval_t e, int depth, const
         else
             player = _("black");
 
-        int eInt = e;
-        int eAbs = (eInt < 0 ? -eInt : eInt);
-        int iInt = VALUE_INFINITE;
-
-        int winInMoves = (iInt - 1 - eAbs) / 2 + 1;
+        int winInMoves = (matePlies(e) - 1) / 2 + 1;
 
         char buf[100];
         if (winInMoves > 1)
@@ -604,15 +889,39 @@ void PlayerIF_AlgoAB::logBestMove(const Variation &v, eval_t e, int depth, const
     } else {
         if (rootPos.getCurrentPlayer() == PL_Black)
             e = -e;
-        strstr << e << ')';
+        strstr << scoreToPieces(e) << ')';
     }
 
-    strstr << " [" << depth << "]" << suffix;
+    return strstr.str();
+}
+
+void PlayerIF_AlgoAB::logBestMove(const Variation &v, eval_t e, int depth, const char *suffix) const
+{
+    std::stringstream strstr;
+
+    strstr << formatVariation(v, e) << " [" << depth << "]" << suffix;
 
     m_tunnel->showThinkingInfo(strstr.str());
 }
 
-void PlayerIF_AlgoAB::notifyWinner(Player p)
+void PlayerIF_AlgoAB::logAnalysis(const std::vector<AnalysisLine> &analysis, int depth) const
+{
+    std::stringstream strstr;
+
+    for (size_t i = 0; i < analysis.size(); i++) {
+        eval_t e = analysis[i].eval;
+        if (rootPos.getCurrentPlayer() == PL_Black)
+            e = -e;
+
+        strstr << (i + 1) << ") " << formatVariation(analysis[i].pv, e) << "  ";
+    }
+
+    strstr << "[" << depth << "]";
+
+    m_tunnel->showThinkingInfo(strstr.str());
+}
+
+void PlayerIF_AlgoAB::notifyWinner(Player p, const GameControl &control)
 {
     if (p == PL_None) {
         return;
@@ -622,11 +931,12 @@ void PlayerIF_AlgoAB::notifyWinner(Player p)
         return;
     }
 
-    const GameControl &control = MainApp::app().getControl();
-
+    std::vector<BoardID> boards;
     for (int i = 0; i < control.getHistorySize() - 1; i++) {
         boost::shared_ptr<Position> pos = control.getHistoryBoard(i);
 
-        m_experience->addBoard(m_ruleSpec->getBoardID_Symmetric(*pos), p);
+        boards.push_back(m_ruleSpec->getBoardID_Symmetric(*pos));
     }
+
+    m_experience->addGame(boards, p);
 }
@@ -22,11 +22,15 @@
 #include "control.hh"
 #include "ttable.hh"
 #include "learn.hh"
+#include "timemgr.hh"
+#include "analysiscache.hh"
+#include "eval.hh"
+#include "nnue.hh"
+#include "searchinfo.hh"
 
 #include <stdlib.h>
 #include <iostream>
 #include <glib.h>
-#include <sys/time.h>
 
 /* A quite standard alpha-beta search algo with a quite basic evaluation function.
    Still, it is a quite competitive player.
@@ -39,16 +43,16 @@ class PlayerIF_AlgoAB : public PlayerIF
 {
 public:
     PlayerIF_AlgoAB();
+    ~PlayerIF_AlgoAB();
 
-    typedef float eval_t;
+    typedef Score eval_t; // see score.hh
     typedef SmallVec<Move, MAXSEARCHDEPTH> Variation;
 
     // --- configuration ---
 
-    void registerTTable(ttable_ptr tt)
-    {
-        m_ttable = tt;
-    }
+    /* The table is taken over when the next search starts. A running search keeps
+       its table, such that the table can be replaced at any time. */
+    void registerTTable(ttable_ptr tt);
     void registerThreadTunnel(ThreadTunnel &tunnel)
     {
         m_tunnel = &tunnel;
@@ -58,11 +62,24 @@ public:
         m_experience = e;
     }
 
+    // Like the table, the cache is taken over when the next search starts. NULL to disable.
+    void registerAnalysisCache(analysiscache_ptr c);
+
+    // Evaluate with the neural network instead of the static evaluation if the
+    // network was trained for the current board. NULL to disable.
+    // Like the table, the network is taken over when the next search starts.
+    void registerNetwork(nnue_ptr n);
+
     // --- AI parameters ---
 
     void setMaxTime_msec(int msecs)
     {
-        m_maxMSecs = msecs;
+        m_timeMgr.setMaxTime_msec(msecs);
+    }
+    // see PlayerIF::setGameClock()
+    void setGameClock(int remainingMSecs, int incrementMSecs)
+    {
+        m_timeMgr.setGameClock(remainingMSecs, incrementMSecs);
     }
     void setMaxDepth(int d)
     {
@@ -71,13 +88,111 @@ public:
 
     int askMaxTime_msec() const
     {
-        return m_maxMSecs;
+        return m_timeMgr.askMaxTime_msec();
     }
     int askMaxDepth() const
     {
         return m_maxDepth;
     }
 
+    // Stop the search after this number of nodes. Zero means no limit.
+    void setMaxNodes(long long n)
+    {
+        m_maxNodes = n;
+    }
+    long long askMaxNodes() const
+    {
+        return m_maxNodes;
+    }
+
+    /* In deterministic mode, the search is only limited by depth and node count and
+       the thinking time is ignored. The transposition table is emptied before each
+       search (see TranspositionTable::newGeneration()) and the root moves are shuffled
+       with the fixed seed (not at all if the seed is zero). For the same position, rules,
+       and parameters (and the same or no experience), the computed move is identical on
+       all machines.
+     */
+    void setDeterministic(bool flag, unsigned long long seed = 0)
+    {
+        m_deterministic = flag;
+        m_randomSeed = seed;
+    }
+    bool isDeterministic() const
+    {
+        return m_deterministic;
+    }
+
+    /* Number of best root moves (principal variations) to compute. With more than one,
+       the root is searched repeatedly in each iteration, excluding the moves found so far.
+       The result is shown as thinking info and can be queried with getAnalysis().
+     */
+    void setMultiPV(int k)
+    {
+        m_multiPV = k;
+    }
+    int askMultiPV() const
+    {
+        return m_multiPV;
+    }
+
+    /* With symmetric transposition-table keys, boards that are symmetric to each other
+       (see RuleSpec::getSymmetricKey()) share their table entry and the best move is stored
+       relative to the canonical board. This pays off mostly in the placing phase.
+       Players that share a table have to use the same setting.
+     */
+    void setSymmetricTT(bool flag)
+    {
+        m_symmetricTT = flag;
+    }
+    bool askSymmetricTT() const
+    {
+        return m_symmetricTT;
+    }
+
+    struct AnalysisLine
+    {
+        eval_t eval; // normalized for white
+        Variation pv;
+    };
+
+    // The best root moves of the last completed iteration. Only valid after the move was sent.
+    const std::vector<AnalysisLine> &getAnalysis() const
+    {
+        return m_analysis;
+    }
+
+    // The score of the last completed iteration, normalized for white. Only valid after the move was sent.
+    eval_t getScore() const
+    {
+        return m_score;
+    }
+
+    /* Statistics of the last completed iteration. They are also sent to the thread-tunnel
+       after each iteration. Only valid after the move was sent. */
+    const SearchInfo &getSearchInfo() const
+    {
+        return m_searchInfo;
+    }
+
+    /* How child positions are generated in the search tree.
+       Make/unmake keeps one copy of the parent and applies doMove()/undoMove() to it,
+       copy/make copies the parent into a per-ply board stack and only applies doMove().
+     */
+    enum SearchStrategy
+    {
+        Search_MakeUnmake,
+        Search_CopyMake
+    };
+
+    void setSearchStrategy(SearchStrategy s)
+    {
+        m_searchStrategy = s;
+    }
+    SearchStrategy askSearchStrategy() const
+    {
+        return m_searchStrategy;
+    }
+
     enum Weight
     {
         Weight_Material,
@@ -114,21 +229,48 @@ public:
     // Cancel the current move (do not send the currently computed move).
     void cancelMove();
 
-    void notifyWinner(Player p);
+    void notifyWinner(Player p, const GameControl &);
 
 private:
     void doSearch();
+    eval_t searchRoot(int depth, Variation &);
+
+    template <SearchStrategy S>
+    eval_t search(const Position &board, eval_t alpha, eval_t beta,
+                 int currDepth, int levels_to_go, Variation &, bool useTT);
 
-    float search(const Position &board, float alpha, float beta,
-                  int currDepth, int levels_to_go, Variation &, bool useTT);
+    eval_t Eval(const Position &board, int ply) const;
 
-    float Eval(const Position &board, int levelsToGo) const;
+    Evaluation m_evaluation;
+    float m_termWeight[Phase_NPHASES][Term_NTERMS];
+    void initEvaluation();
+
+    nnue_ptr m_registeredNetwork;
+    nnue_ptr m_network; // the network of the current search, owned until the next search
+    const NNUENetwork *m_activeNetwork; // m_network if it was trained for the board, else NULL
+    NNUEAccumulator m_accStack[MAXSEARCHDEPTH + 1]; // accumulators along the searched path, by ply
 
     Position rootPos;
     Move m_move; // the move that is currently computed
 
+    Position m_plyStack[MAXSEARCHDEPTH + 1]; // child positions for Search_CopyMake
+
     //PositionMemory m_posMemory;  // TODO: disabled, because not as effective as Experience
     experience_ptr m_experience;
+    analysiscache_ptr m_registeredAnalysisCache;
+    analysiscache_ptr m_analysisCache; // the cache of the current search, owned until the next search
+
+    void startFromAnalysisCache();
+
+    // The table key of the board and the index of the permutation to the canonical board
+    // (-1 without symmetric keys). Moves in the table are mapped with the functions below.
+    Key ttKey(const Position &, int &permutationIdx) const;
+    Move ttMoveToBoard(const Move &, int permutationIdx) const;
+    Move ttMoveFromBoard(const Move &, int permutationIdx) const;
+
+    // Sort moves[first..] by the table entries of their child positions, unknown ones last.
+    // The table keys of the children are sorted along with the moves.
+    void orderMovesByTT(std::vector<Move> &moves, std::vector<Key> &childKeys, size_t first) const;
 
     // multi-threading management
 
@@ -138,6 +280,8 @@ private:
 
     class ThreadTunnel *m_tunnel;
     GThread *thread;
+    GMutex m_threadMutex; // The join handler may run in another thread than cancelMove().
+    GMutex m_registerMutex; // registered objects are taken over by the search thread
     int m_moveID;
 
     bool m_stopThread;
@@ -146,25 +290,44 @@ private:
 
     // time management
 
-    struct timeval m_startTime; // time when move was started
+    TimeManager m_timeMgr;
     void checkTime();
 
     // configuration
 
-    ttable_ptr m_ttable;
-    int m_maxMSecs;
+    ttable_ptr m_registeredTTable;
+    ttable_ptr m_ttable; // the table of the current search, owned until the next search
+    bool m_symmetricTT;
     int m_maxDepth;
+    long long m_maxNodes;
+    SearchStrategy m_searchStrategy;
+    bool m_deterministic;
+    unsigned long long m_randomSeed;
+    RandomGenerator m_random; // for the root move order
+    int m_multiPV;
+
+    std::vector<Move> m_excludedRootMoves; // moves already found in the current multi-PV iteration
+    std::vector<AnalysisLine> m_analysis;
+    eval_t m_score;
     float m_weight[Weight_NWEIGHTS];
 
     // visualization
 
+    std::string formatVariation(const Variation &, eval_t) const;
     void logBestMove(const Variation &, eval_t, int depth, const char *suffix = "") const;
+    void logAnalysis(const std::vector<AnalysisLine> &, int depth) const;
     void logBestMove(const Move &, eval_t, int depth) const;
     void logBestMoveFromTable(const Position &, const Move &, eval_t, int depth) const;
 
     // statistics
 
-    mutable int m_nodesEvaluated;
+    mutable long long m_nodesEvaluated;
+    long long m_nodesSearched;
+    int m_selDepth;
+    long long m_prevIterationNodes;
+    SearchInfo m_searchInfo;
+
+    void reportSearchInfo(int depth, eval_t score);
 
     // debug
     int moveCnt;
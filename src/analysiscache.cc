@@ -0,0 +1,261 @@
+/***************************************************************************
+  This file is part of Morris.
+  Copyright (C) 2009 Dirk Farin <dirk.farin@gmail.com>
+
+  Morris is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+***************************************************************************/
+
+
+#include "config.h"
+#include "analysiscache.hh"
+
+#include <iostream>
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#if HAVE_SYS_MMAN_H && HAVE_MMAP
+#define USE_MMAP 1
+#include <sys/mman.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#else
+#define USE_MMAP 0
+#endif
+
+static const char MAGIC[8] = { 'M', 'O', 'R', 'R', 'I', 'S', 'A', 'C' };
+static const int VERSION = 3; // 2: integer scores, 3: symmetries map mills onto mills
+
+AnalysisCache::AnalysisCache(const std::string &filename, int nBits)
+    : m_filename(filename),
+    m_nBits(nBits),
+    m_data(NULL),
+    m_table(NULL),
+    m_mapped(false),
+    m_fd(-1)
+{
+    g_mutex_init(&m_mutex);
+
+    m_tableSize = 1 << nBits;
+    m_dataSize = sizeof(Header) + m_tableSize * sizeof(Entry);
+
+    open();
+}
+
+AnalysisCache::~AnalysisCache()
+{
+    save();
+    close();
+
+    g_mutex_clear(&m_mutex);
+}
+
+void AnalysisCache::open()
+{
+    Header expected;
+    memcpy(expected.magic, MAGIC, sizeof(MAGIC));
+    expected.version = VERSION;
+    expected.nBits = m_nBits;
+
+#if USE_MMAP
+    m_fd = ::open(m_filename.c_str(), O_RDWR | O_CREAT, 0644);
+    if (m_fd < 0) {
+        std::cerr << "cannot open analysis cache " << m_filename << "\n";
+        return;
+    }
+
+    // start with an empty file if it is not a valid cache of the right size
+
+    Header header;
+    struct stat st;
+    if (fstat(m_fd, &st) != 0 ||
+        size_t(st.st_size) != m_dataSize ||
+        read(m_fd, &header, sizeof(Header)) != sizeof(Header) ||
+        memcmp(&header, &expected, sizeof(Header)) != 0) {
+        if (ftruncate(m_fd, 0) != 0 ||
+            ftruncate(m_fd, m_dataSize) != 0 ||
+            pwrite(m_fd, &expected, sizeof(Header), 0) != sizeof(Header)) {
+            std::cerr << "cannot initialize analysis cache " << m_filename << "\n";
+            close();
+            return;
+        }
+    }
+
+    void *data = mmap(NULL, m_dataSize, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, 0);
+    if (data == MAP_FAILED) {
+        std::cerr << "cannot map analysis cache " << m_filename << "\n";
+        close();
+        return;
+    }
+
+    m_data = (char *)data;
+    m_mapped = true;
+#else
+    m_data = (char *)calloc(m_dataSize, 1);
+    memcpy(m_data, &expected, sizeof(Header));
+
+    FILE *fh = fopen(m_filename.c_str(), "rb");
+    if (fh) {
+        if (fread(m_data, 1, m_dataSize, fh) != m_dataSize ||
+            memcmp(m_data, &expected, sizeof(Header)) != 0) {
+            memset(m_data, 0, m_dataSize);
+            memcpy(m_data, &expected, sizeof(Header));
+        }
+
+        fclose(fh);
+    }
+#endif
+
+    m_table = (Entry *)(m_data + sizeof(Header));
+}
+
+void AnalysisCache::close()
+{
+#if USE_MMAP
+    if (m_mapped) {
+        munmap(m_data, m_dataSize);
+    }
+    if (m_fd >= 0) {
+        ::close(m_fd);
+    }
+
+    m_fd = -1;
+    m_mapped = false;
+#else
+    free(m_data);
+#endif
+
+    m_data = NULL;
+    m_table = NULL;
+}
+
+void AnalysisCache::save()
+{
+    if (m_table == NULL) {
+        return;
+    }
+
+    g_mutex_lock(&m_mutex);
+
+#if USE_MMAP
+    msync(m_data, m_dataSize, MS_ASYNC);
+#else
+    FILE *fh = fopen(m_filename.c_str(), "wb");
+    if (fh) {
+        if (fwrite(m_data, 1, m_dataSize, fh) != m_dataSize) {
+            std::cerr << "cannot write analysis cache " << m_filename << "\n";
+        }
+
+        fclose(fh);
+    }
+#endif
+
+    g_mutex_unlock(&m_mutex);
+}
+
+AnalysisCache::Entry *AnalysisCache::findEntry(Key rulesKey, BoardID id) const
+{
+    const int mask = m_tableSize - 1;
+    const int idx = (id ^ (rulesKey * 0x9E3779B97F4A7C15ULL)) & mask;
+
+    // Return the entry of this position, or the entry to be replaced if there is none.
+
+    Entry *replace = NULL;
+
+    for (int i = 0; i < NPROBES; i++) {
+        Entry *e = &m_table[(idx + i) & mask];
+
+        if (e->depth != 0 && e->id == id && e->rulesKey == rulesKey) {
+            return e;
+        }
+
+        if (replace == NULL || e->depth < replace->depth) {
+            replace = e;
+        }
+    }
+
+    return replace;
+}
+
+bool AnalysisCache::lookup(const RuleSpec &rules, const Board &board, Result &result) const
+{
+    if (m_table == NULL) {
+        return false;
+    }
+
+    int permIdx = 0;
+    const BoardID id = rules.getBoardID_Symmetric(board, &permIdx);
+    const Key rulesKey = rules.getRulesKey();
+
+    g_mutex_lock(&m_mutex);
+
+    const Entry *e = findEntry(rulesKey, id);
+    const bool found = (e->depth != 0 && e->id == id && e->rulesKey == rulesKey);
+
+    if (found) {
+        Move m;
+        m.mode = Move::MoveMode(e->mode);
+        m.oldPos = e->oldPos;
+        m.newPos = e->newPos;
+        for (int i = 0; i < e->nTakes; i++) {
+            m.addTake(e->takes[i]);
+        }
+
+        // map move back from the canonical board
+        result.bestMove = permuteMove(m, rules.boardSpec->getInversePermutations()[permIdx]);
+        result.eval = e->eval;
+        result.depth = e->depth;
+    }
+
+    g_mutex_unlock(&m_mutex);
+
+    return found;
+}
+
+void AnalysisCache::store(const RuleSpec &rules, const Board &board, const Result &result)
+{
+    if (m_table == NULL) {
+        return;
+    }
+
+    int permIdx = 0;
+    const BoardID id = rules.getBoardID_Symmetric(board, &permIdx);
+    const Key rulesKey = rules.getRulesKey();
+
+    // store move relative to the canonical board
+    const Move m = permuteMove(result.bestMove, rules.boardSpec->getPermutations()[permIdx]);
+
+    g_mutex_lock(&m_mutex);
+
+    Entry *e = findEntry(rulesKey, id);
+    const bool samePosition = (e->depth != 0 && e->id == id && e->rulesKey == rulesKey);
+
+    if (!samePosition || result.depth >= e->depth) {
+        e->rulesKey = rulesKey;
+        e->id = id;
+        e->eval = result.eval;
+        e->depth = result.depth;
+        e->mode = m.mode;
+        e->oldPos = m.oldPos;
+        e->newPos = m.newPos;
+        e->nTakes = m.takes.size();
+        for (int i = 0; i < m.takes.size(); i++) {
+            e->takes[i] = m.takes[i];
+        }
+    }
+
+    g_mutex_unlock(&m_mutex);
+}
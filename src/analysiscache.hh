@@ -0,0 +1,103 @@
+/***************************************************************************
+  This file is part of Morris.
+  Copyright (C) 2009 Dirk Farin <dirk.farin@gmail.com>
+
+  Morris is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+***************************************************************************/
+
+
+#ifndef ANALYSISCACHE_HH
+#define ANALYSISCACHE_HH
+
+#include "rules.hh"
+#include "score.hh"
+
+#include <string>
+#include <glib.h>
+#include <boost/shared_ptr.hpp>
+
+/* The analysis cache keeps the results of root searches across program sessions.
+   Positions are identified by their symmetric board ID, such that rotated or mirrored
+   positions share their entry. The best move is stored relative to the canonical
+   board and mapped back to the actual board orientation on lookup.
+
+   The cache is a fixed-size table in a file, which is memory-mapped if the system
+   supports it. Otherwise, it is read completely at startup and written back by save()
+   and in the destructor. If the file cannot be used, the cache stays empty.
+ */
+class AnalysisCache
+{
+public:
+    AnalysisCache(const std::string &filename, int nBits);
+    ~AnalysisCache();
+
+    struct Result
+    {
+        Score eval; // relative to the player to move
+        int depth;
+        Move bestMove;
+    };
+
+    bool lookup(const RuleSpec &, const Board &, Result &) const;
+    void store(const RuleSpec &, const Board &, const Result &);
+
+    void save();
+
+private:
+    struct Header
+    {
+        char magic[8];
+        int version;
+        int nBits;
+    };
+
+    struct Entry
+    {
+        Key rulesKey;
+        BoardID id;
+        Score eval;
+        signed char depth; // zero for empty entries
+        signed char mode;
+        signed char oldPos;
+        signed char newPos;
+        signed char takes[Move::MAXTAKES];
+        signed char nTakes;
+    };
+
+    enum
+    {
+        NPROBES = 4 // number of consecutive entries in which a position may be stored
+    };
+
+    Entry *findEntry(Key rulesKey, BoardID id) const;
+    void open();
+    void close();
+
+    std::string m_filename;
+    int m_nBits;
+
+    char *m_data; // header followed by the entries
+    size_t m_dataSize;
+    Entry *m_table;
+    int m_tableSize;
+
+    bool m_mapped;
+    int m_fd;
+
+    mutable GMutex m_mutex;
+};
+
+typedef boost::shared_ptr<AnalysisCache> analysiscache_ptr;
+
+#endif
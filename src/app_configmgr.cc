@@ -92,6 +92,22 @@ void ConfigManager_Application::readInitialValues()
 
     store(ai_settings, itemComputers_shareTTables,
           read_bool(ai_settings, itemComputers_shareTTables));
+    store(ai_settings, itemComputers_analysisCache,
+          read_bool(ai_settings, itemComputers_analysisCache));
+    store(ai_settings, itemComputers_symmetricTTables,
+          read_bool(ai_settings, itemComputers_symmetricTTables));
+    store(ai_settings, itemComputers_neuralNetwork,
+          read_bool(ai_settings, itemComputers_neuralNetwork));
+
+    // store() skips unchanged values, but the tables start with the compiled-in size
+    MainApp::app().setTTableSize(read_int(ai_settings, itemComputers_ttableSize));
+    setGameClock();
+}
+
+void ConfigManager_Application::setGameClock()
+{
+    MainApp::app().getControl().setGameClock(60 * 1000 * read_int(ai_settings, itemComputers_clockMinutes),
+                                             1000 * read_int(ai_settings, itemComputers_clockIncrement));
 }
 
 void ConfigManager_Application::store(GSettings *settings, const char *key, int value)
@@ -116,6 +132,16 @@ void ConfigManager_Application::store(GSettings *settings, const char *key, int
         }
     }
 
+    if (cmp(key, itemComputers_ttableSize)) {
+        MainApp::app().setTTableSize(value);
+        return;
+    }
+
+    if (cmp(key, itemComputers_clockMinutes) || cmp(key, itemComputers_clockIncrement)) {
+        setGameClock();
+        return;
+    }
+
     if (m_delegate != NULL) {
         m_delegate->store(settings, key, value);
     }
@@ -133,6 +159,12 @@ void ConfigManager_Application::store(GSettings *settings, const char *key, bool
         menu_setPauseOnAI(value);
     } else if (cmp(key, itemComputers_shareTTables)) {
         MainApp::app().setShareTTables(value);
+    } else if (cmp(key, itemComputers_analysisCache)) {
+        MainApp::app().setUseAnalysisCache(value);
+    } else if (cmp(key, itemComputers_symmetricTTables)) {
+        MainApp::app().setSymmetricTTables(value);
+    } else if (cmp(key, itemComputers_neuralNetwork)) {
+        MainApp::app().setUseNeuralNetwork(value);
     } else if (m_delegate != NULL) {
         m_delegate->store(settings, key, value);
     }
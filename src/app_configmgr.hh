@@ -51,6 +51,9 @@ public:
     virtual bool read_bool(GSettings *settings, const char *key);
     virtual float read_float(GSettings *settings, const char *key);
     virtual std::string read_string(GSettings *settings, const char *key);
+
+private:
+    void setGameClock(); // from the two game-clock settings
 };
 
 #endif
@@ -22,6 +22,7 @@
 #include <boost/shared_ptr.hpp>
 #include "boardgui.hh"
 #include "util.hh"
+#include "searchinfo.hh"
 
 class ApplicationGUI
 {
@@ -36,6 +37,9 @@ public:
     virtual void setStatusbar(const std::string &)
     {
     }
+    virtual void setSearchInfo(const SearchInfo &)
+    {
+    }
 
     virtual void showGameOverDialog(Player winner)
     {
@@ -66,10 +66,13 @@ std::ostream &operator<<(std::ostream &ostr, const Move &m)
     return ostr;
 }
 
-// generate a random key value
+/* Generate a random key value. The keys are generated with a fixed seed, such that
+   they are the same in every run and on every machine. Otherwise, transposition-table
+   collisions and thus search results would differ between runs. */
 static Key randomHash()
 {
-    return Key(rand()) ^ (Key(rand()) << 16) ^ (Key(rand()) << 32) ^ (Key(rand()) << 48);
+    static RandomGenerator random(0x4D6F72726973ULL);
+    return random.next();
 }
 
 Key Board::hash_pos[3][MAXPOSITIONS];
@@ -99,6 +102,7 @@ void Board::reset(int p_nPiecesToSet)
 
     nPiecesToSet[0] = nPiecesToSet[1] = p_nPiecesToSet;
     nPiecesOnBoard[0] = nPiecesOnBoard[1] = 0;
+    pieceBits[0] = pieceBits[1] = 0;
 
     key = hash_nToSet[0][p_nPiecesToSet] ^ hash_nToSet[2][p_nPiecesToSet];
 
@@ -119,6 +123,7 @@ void Board::doMove(const Move &m)
         assert(nPiecesToSet[playerIndex] > 0);
 
         boardPos[m.newPos] = currentPlayer;
+        pieceBits[playerIndex] |= positionBit(m.newPos);
         key ^= hash_pos[currentPlayer + 1][m.newPos];
         key ^= hash_nToSet[currentPlayer + 1][nPiecesToSet[playerIndex]];
         key ^= hash_nToSet[currentPlayer + 1][nPiecesToSet[playerIndex] - 1];
@@ -132,6 +137,7 @@ void Board::doMove(const Move &m)
     {
         boardPos[m.oldPos] = PL_None;
         boardPos[m.newPos] = currentPlayer;
+        pieceBits[player2Index(currentPlayer)] ^= positionBit(m.oldPos) | positionBit(m.newPos);
         key ^= hash_pos[currentPlayer + 1][m.oldPos];
         key ^= hash_pos[currentPlayer + 1][m.newPos];
     }
@@ -145,6 +151,7 @@ void Board::doMove(const Move &m)
 
         boardPos[m.takes[i]] = PL_None;
         nPiecesOnBoard[player2Index(opponent(currentPlayer))]--;
+        pieceBits[player2Index(opponent(currentPlayer))] &= ~positionBit(m.takes[i]);
 
         key ^= hash_pos[opponent(currentPlayer) + 1][m.takes[i]];
     }
@@ -156,6 +163,34 @@ void Board::doMove(const Move &m)
     //assert(key == hashFromScratch());
 }
 
+Key Board::keyAfter(const Move &m) const
+{
+    Key k = key;
+
+    switch (m.mode) {
+    case Move::Mode_Set:
+    {
+        const int nToSet = nPiecesToSet[player2Index(currentPlayer)];
+
+        k ^= hash_pos[currentPlayer + 1][m.newPos];
+        k ^= hash_nToSet[currentPlayer + 1][nToSet];
+        k ^= hash_nToSet[currentPlayer + 1][nToSet - 1];
+    }
+    break;
+
+    case Move::Mode_Move:
+        k ^= hash_pos[currentPlayer + 1][m.oldPos];
+        k ^= hash_pos[currentPlayer + 1][m.newPos];
+        break;
+    }
+
+    for (int i = 0; i < m.takes.size(); i++) {
+        k ^= hash_pos[opponent(currentPlayer) + 1][m.takes[i]];
+    }
+
+    return k ^ hash_playerToggle;
+}
+
 void Board::undoMove(const Move &m)
 {
     togglePlayer();
@@ -165,6 +200,7 @@ void Board::undoMove(const Move &m)
     for (int i = 0; i < m.takes.size(); i++) {
         boardPos[m.takes[i]] = opponent(currentPlayer);
         nPiecesOnBoard[player2Index(opponent(currentPlayer))]++;
+        pieceBits[player2Index(opponent(currentPlayer))] |= positionBit(m.takes[i]);
 
         key ^= hash_pos[opponent(currentPlayer) + 1][m.takes[i]];
     }
@@ -177,6 +213,7 @@ void Board::undoMove(const Move &m)
         const int playerIndex = player2Index(currentPlayer);
 
         boardPos[m.newPos] = PL_None;
+        pieceBits[playerIndex] &= ~positionBit(m.newPos);
         key ^= hash_pos[currentPlayer + 1][m.newPos];
         key ^= hash_nToSet[currentPlayer + 1][nPiecesToSet[playerIndex]];
         key ^= hash_nToSet[currentPlayer + 1][nPiecesToSet[playerIndex] + 1];
@@ -188,12 +225,29 @@ void Board::undoMove(const Move &m)
     case Move::Mode_Move:
         boardPos[m.oldPos] = currentPlayer;
         boardPos[m.newPos] = PL_None;
+        pieceBits[player2Index(currentPlayer)] ^= positionBit(m.oldPos) | positionBit(m.newPos);
         key ^= hash_pos[currentPlayer + 1][m.oldPos];
         key ^= hash_pos[currentPlayer + 1][m.newPos];
         break;
     }
 }
 
+void Board::setState(Player current, int nToSetWhite, int nToSetBlack)
+{
+    currentPlayer = current;
+
+    nPiecesToSet[player2Index(PL_White)] = nToSetWhite;
+    nPiecesToSet[player2Index(PL_Black)] = nToSetBlack;
+
+    nPiecesOnBoard[0] = nPiecesOnBoard[1] = 0;
+    for (int i = 0; i < MAXPOSITIONS; i++)
+        if (boardPos[i] != PL_None) {
+            nPiecesOnBoard[player2Index(Player(boardPos[i]))]++;
+        }
+
+    key = hashFromScratch();
+}
+
 Key Board::hashFromScratch() const
 {
     Key h = 0;
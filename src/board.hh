@@ -136,6 +136,11 @@ public:
         return boardPos[p] == PL_None;
     }
 
+    PositionBits getPieceBits(Player p) const
+    {
+        return pieceBits[player2Index(p)];
+    }
+
     // --- counting pieces ---
 
     short getNPiecesToSet(Player p) const
@@ -182,13 +187,25 @@ public:
     {
         return key;
     }
+
+    // The key of the position after the move, derived without changing the board.
+    Key keyAfter(const Move &) const;
     static void initHashValues(); // fill the key tables with random values
 
     // --- hard board modification, not considering the key value ---
 
+    /* Set the remaining state after all pieces were placed with setPosition_noHash().
+       The number of pieces on the board and the key are recomputed. */
+    void setState(Player current, int nToSetWhite, int nToSetBlack);
+
     void setPosition_noHash(int p, Player pl)
     {
         boardPos[p] = pl;
+
+        pieceBits[0] &= ~positionBit(p);
+        pieceBits[1] &= ~positionBit(p);
+        if (pl != PL_None)
+            pieceBits[player2Index(pl)] |= positionBit(p);
     }
 
     // --- standard operators ---
@@ -206,6 +223,7 @@ private:
     Player currentPlayer;
     signed char nPiecesToSet[2];
     signed char nPiecesOnBoard[2];
+    PositionBits pieceBits[2]; // redundant to boardPos, for fast symmetry computations
 
     boost::shared_ptr<Position> prev;
 
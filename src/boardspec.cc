@@ -18,6 +18,9 @@
 
 #include "boardspec.hh"
 #include <cmath>
+#include <map>
+#include <algorithm>
+#include <glib.h>
 
 BoardSpec_Polygon::BoardSpec_Polygon(int nCorners)
 {
@@ -761,74 +764,243 @@ boardspec_ptr BoardSpec::boardFactory(BoardSpec::BoardPreset preset)
     return boardspec_ptr(spec);
 }
 
-void BoardSpec::recursePermutation(Permutation &p, UsageVector &used, int pos)
+void BoardSpec::recursePermutation(Permutation &p, UsageVector &used, UsageVector &assigned,
+                                   const std::vector<int> &order, const std::vector<int> &posClass, int k)
 {
     // If permutation vector is complete, store it into the set.
 
-    if (pos == nPositions()) {
-        /*
-            for (int i=0;i<pos;i++)
-          {
-            std::cout << int(p[i]) << " ";
-          }
-            std::cout << "\n";
-            */
-
-        m_permutations.push_back(p);
+    if (k == nPositions()) {
+        if (preservesMills(p))
+            m_permutations.push_back(p);
 
         return;
     }
 
+    const int pos = order[k];
+    const NeighborVector &srcNeigh = getNeighbors(pos);
+
     for (int i = 0; i < nPositions(); i++)
-        if (used[i] == false) {
-            const NeighborVector &srcNeigh = getNeighbors(pos);
+        if (used[i] == false && posClass[i] == posClass[pos]) {
             const NeighborVector &dstNeigh = getNeighbors(i);
 
-            // check for compatible node types (same number of neighbors)
+            // check for compatible local topology (already assigned neighbors must be mapped to neighbors)
 
-            if (srcNeigh.size() == dstNeigh.size()) {
-                bool compatible = true;
+            bool compatible = true;
+            for (int j = 0; j < srcNeigh.size() && compatible; j++) {
+                if (assigned[srcNeigh[j]]) {
+                    bool isNeighbor = false;
+                    for (int n = 0; n < dstNeigh.size(); n++)
+                        if (dstNeigh[n] == p[srcNeigh[j]])
+                            isNeighbor = true;
 
-                // check for compatible local topology (already assigned neighbors must be equal)
+                    if (!isNeighbor)
+                        compatible = false;
+                }
+            }
 
-                for (int k = 0; k < srcNeigh.size(); k++) {
-                    if (srcNeigh[k] < pos) // check the previous neighbors for neighborhood with 'i'
-                    {
-                        bool isNeighbor = false;
-                        for (int n = 0; n < dstNeigh.size(); n++)
-                            if (dstNeigh[n] == p[srcNeigh[k]])
-                                isNeighbor = true;
+            // if the assignment is compatible, we continue with the next position
 
-                        if (!isNeighbor)
-                            compatible = false;
-                    }
-                }
+            if (compatible) {
+                used[i] = true;
+                assigned[pos] = true;
+                p[pos] = i;
+
+                recursePermutation(p, used, assigned, order, posClass, k + 1);
+
+                used[i] = false;
+                assigned[pos] = false;
+            }
+        }
+}
 
-                // if the assignment is compatible (up to 'pos'), we continue with the next position
+bool BoardSpec::preservesMills(const Permutation &p) const
+{
+    for (int m = 0; m < nMills(); m++) {
+        const MillPosVector &mill = getMill(m);
 
-                if (compatible) {
-                    used[i] = true;
-                    p[pos] = i;
+        /* The permuted mill must be one of the mills through its first position.
+           These are given by the other positions of the mill. */
 
-                    recursePermutation(p, used, pos + 1);
+        const std::vector<MillPosVector> &candidates = getMillsThroughPos(p[mill[0]]);
 
-                    used[i] = false;
-                }
+        bool found = false;
+        for (int c = 0; c < candidates.size() && !found; c++) {
+            if (candidates[c].size() != mill.size() - 1)
+                continue;
+
+            bool equal = true;
+            for (int i = 1; i < mill.size() && equal; i++) {
+                bool contained = false;
+                for (int j = 0; j < candidates[c].size(); j++)
+                    if (candidates[c][j] == p[mill[i]])
+                        contained = true;
+
+                equal = contained;
             }
+
+            found = equal;
         }
+
+        if (!found)
+            return false;
+    }
+
+    return true;
 }
 
-void BoardSpec::initPermutations()
+static bool lessPermutation(const BoardSpec::Permutation &a, const BoardSpec::Permutation &b)
+{
+    for (int i = 0; i < a.size(); i++)
+        if (a[i] != b[i])
+            return a[i] < b[i];
+
+    return false;
+}
+
+void BoardSpec::findPermutations()
 {
+    const int nPos = nPositions();
+
+    /* Partition the positions into classes that cannot be mapped onto each other.
+       Start with the number of neighbors and mills through each position and refine
+       the classes by the classes of the neighbors until the partition is stable.
+     */
+
+    std::vector<int> posClass(nPos);
+    int nClasses = 0;
+
+    for (int iter = 0;; iter++) {
+        std::map<std::vector<int>, int> classOfSignature;
+        std::vector<int> newClass(nPos);
+
+        for (int p = 0; p < nPos; p++) {
+            std::vector<int> signature;
+
+            if (iter == 0) {
+                signature.push_back(getNeighbors(p).size());
+                signature.push_back(getMillsThroughPos(p).size());
+            } else {
+                const NeighborVector &neighbors = getNeighbors(p);
+                for (int n = 0; n < neighbors.size(); n++)
+                    signature.push_back(posClass[neighbors[n]]);
+
+                std::sort(signature.begin(), signature.end());
+                signature.insert(signature.begin(), posClass[p]);
+            }
+
+            std::map<std::vector<int>, int>::const_iterator it = classOfSignature.find(signature);
+            if (it == classOfSignature.end()) {
+                const int c = classOfSignature.size();
+                classOfSignature[signature] = c;
+                newClass[p] = c;
+            } else {
+                newClass[p] = it->second;
+            }
+        }
+
+        posClass = newClass;
+
+        if (iter > 0 && classOfSignature.size() == nClasses)
+            break;
+
+        nClasses = classOfSignature.size();
+    }
+
+    /* Assign the positions in breadth-first order, starting with a position of the
+       smallest class. Thus, most positions have assigned neighbors when they are
+       reached, which prunes the search early. */
+
+    std::vector<int> classSize(nClasses, 0);
+    for (int p = 0; p < nPos; p++)
+        classSize[posClass[p]]++;
+
+    std::vector<int> order;
+    std::vector<bool> inOrder(nPos, false);
+
+    while (order.size() < nPos) {
+        int start = -1;
+        for (int p = 0; p < nPos; p++)
+            if (!inOrder[p] && (start < 0 || classSize[posClass[p]] < classSize[posClass[start]]))
+                start = p;
+
+        inOrder[start] = true;
+        order.push_back(start);
+
+        for (int k = order.size() - 1; k < order.size(); k++) {
+            const NeighborVector &neighbors = getNeighbors(order[k]);
+            for (int n = 0; n < neighbors.size(); n++)
+                if (!inOrder[neighbors[n]]) {
+                    inOrder[neighbors[n]] = true;
+                    order.push_back(neighbors[n]);
+                }
+        }
+    }
+
     Permutation p;
-    UsageVector used;
+    UsageVector used, assigned;
 
-    for (int i = 0; i < nPositions(); i++)
-        used[i] = false;
+    for (int i = 0; i < nPos; i++)
+        used[i] = assigned[i] = false;
+
+    p.resize(nPos);
+
+    recursePermutation(p, used, assigned, order, posClass, 0);
 
-    p.resize(nPositions());
+    // sort, such that the identity comes first
+    std::sort(m_permutations.begin(), m_permutations.end(), lessPermutation);
+}
+
+void BoardSpec::initPermutations()
+{
+    // The permutations only depend on the board, hence, they are cached per preset.
 
-    //std::cout << "--- BEGIN ---\n";
-    recursePermutation(p, used, 0);
-    //std::cout << "--- END ---\n";
+    static std::map<BoardPreset, std::vector<Permutation> > cache;
+    static GMutex cacheMutex;
+
+    const BoardPreset preset = getBoardPresetID();
+
+    if (preset == Board_Unknown) {
+        findPermutations();
+    } else {
+        g_mutex_lock(&cacheMutex);
+
+        std::map<BoardPreset, std::vector<Permutation> >::const_iterator it = cache.find(preset);
+        if (it != cache.end()) {
+            m_permutations = it->second;
+        } else {
+            findPermutations();
+            cache[preset] = m_permutations;
+        }
+
+        g_mutex_unlock(&cacheMutex);
+    }
+
+    m_inversePermutations.resize(m_permutations.size());
+    for (int i = 0; i < m_permutations.size(); i++) {
+        m_inversePermutations[i].resize(nPositions());
+        for (int p = 0; p < nPositions(); p++)
+            m_inversePermutations[i][m_permutations[i][p]] = p;
+    }
+
+    initPermutationBits();
+}
+
+void BoardSpec::initPermutationBits()
+{
+    m_nPermutationBytes = (nPositions() + 7) / 8;
+    m_permutationBits.resize(m_permutations.size() * PERMUTATION_BYTES * 256);
+
+    for (int perm = 0; perm < m_permutations.size(); perm++)
+        for (int byte = 0; byte < PERMUTATION_BYTES; byte++)
+            for (int value = 0; value < 256; value++) {
+                PositionBits bits = 0;
+
+                for (int b = 0; b < 8; b++) {
+                    const int pos = byte * 8 + b;
+                    if ((value & (1 << b)) && pos < nPositions())
+                        bits |= positionBit(m_permutations[perm][pos]);
+                }
+
+                m_permutationBits[(perm * PERMUTATION_BYTES + byte) * 256 + value] = bits;
+            }
 }
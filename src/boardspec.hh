@@ -78,6 +78,26 @@ public:
         return m_permutations;
     }
 
+    // The inverse of each of the permutations above.
+    const std::vector<Permutation> &getInversePermutations() const
+    {
+        return m_inversePermutations;
+    }
+
+    // Apply permutation 'perm' to a set of positions. This uses precomputed tables per byte.
+    PositionBits permuteBits(int perm, PositionBits bits) const
+    {
+        const PositionBits *table = &m_permutationBits[perm * PERMUTATION_BYTES * 256];
+
+        PositionBits result = 0;
+        for (int i = 0; i < m_nPermutationBytes; i++, table += 256) {
+            result |= table[bits & 0xFF];
+            bits >>= 8;
+        }
+
+        return result;
+    }
+
     enum BoardPreset
     {
         Board_Standard9MM,
@@ -114,9 +134,22 @@ protected:
 
 private:
     typedef bool UsageVector[MAXPOSITIONS];
-    void recursePermutation(Permutation &, UsageVector &used, int pos);
+    void findPermutations();
+    void recursePermutation(Permutation &, UsageVector &used, UsageVector &assigned,
+                            const std::vector<int> &order, const std::vector<int> &posClass, int k);
+    bool preservesMills(const Permutation &) const;
+    void initPermutationBits();
 
     std::vector<Permutation> m_permutations;
+    std::vector<Permutation> m_inversePermutations;
+
+    enum
+    {
+        PERMUTATION_BYTES = (MAXPOSITIONS + 7) / 8
+    };
+
+    std::vector<PositionBits> m_permutationBits; // [permutation][byte][byte value]
+    int m_nPermutationBytes;
 };
 
 /* An implementation of the board-specification interface which makes it
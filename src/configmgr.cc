@@ -27,6 +27,12 @@ const char *ConfigManager::itemComputer_weightMills[2] = { "mills", "mills" };
 const char *ConfigManager::itemComputer_weightExperience[2] = { "experience", "experience" };
 
 const char *ConfigManager::itemComputers_shareTTables = "share-transposition-tables";
+const char *ConfigManager::itemComputers_analysisCache = "persistent-analysis-cache";
+const char *ConfigManager::itemComputers_symmetricTTables = "symmetric-transposition-tables";
+const char *ConfigManager::itemComputers_neuralNetwork = "neural-network-evaluation";
+const char *ConfigManager::itemComputers_ttableSize = "transposition-table-size";
+const char *ConfigManager::itemComputers_clockMinutes = "game-clock-minutes";
+const char *ConfigManager::itemComputers_clockIncrement = "game-clock-increment";
 
 const char *ConfigManager::itemDisplay_showGameOverMessageBox = "show-game-over-message-box";
 const char *ConfigManager::itemDisplayGtk_showCoordinates = "show-board-coordinates";
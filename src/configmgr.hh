@@ -103,6 +103,12 @@ public:
     static const char *itemComputer_weightExperience[2];
 
     static const char *itemComputers_shareTTables;
+    static const char *itemComputers_analysisCache;
+    static const char *itemComputers_symmetricTTables;
+    static const char *itemComputers_neuralNetwork;
+    static const char *itemComputers_ttableSize;
+    static const char *itemComputers_clockMinutes;
+    static const char *itemComputers_clockIncrement;
 
     static const char *itemDisplay_showGameOverMessageBox;
     static const char *itemDisplayGtk_showCoordinates;
@@ -45,4 +45,14 @@ enum
     TRANSPOSITION_TABLE_SIZE = 20
 }; // significant bits for the transposition-table key
 
+enum
+{
+    ANALYSIS_CACHE_SIZE = 16
+}; // significant bits for the persistent analysis-cache index
+
+enum
+{
+    EXPERIENCE_SIZE = 12
+}; // initial number of significant bits for the experience hash-table
+
 #endif
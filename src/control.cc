@@ -20,6 +20,7 @@
 #include "threadtunnel.hh"
 
 #include <iostream>
+#include <algorithm>
 
 GameControl::GameControl()
 {
@@ -31,6 +32,9 @@ GameControl::GameControl()
 
     m_moveID = 0;
 
+    m_clockTotalMSecs = 0;
+    m_clockIncrementMSecs = 0;
+
     // setup some game ...
 
     m_ruleSpec = RuleSpec::createPresetRule(RuleSpec::Preset_Standard);
@@ -77,6 +81,31 @@ void GameControl::registerRuleSpec(rulespec_ptr r)
     m_gameState.state = GameState::Idle;
 }
 
+void GameControl::setGameClock(int totalMSecs, int incrementMSecs)
+{
+    m_clockTotalMSecs = totalMSecs;
+    m_clockIncrementMSecs = incrementMSecs;
+
+    m_clockRemainingMSecs[0] = m_clockRemainingMSecs[1] = totalMSecs;
+}
+
+// Charge the time of the move that just ended to the current player.
+void GameControl::advanceClock()
+{
+    if (m_clockTotalMSecs == 0)     {
+        return;
+    }
+
+    struct timeval now;
+    gettimeofday(&now, NULL);
+
+    const int elapsedMS = (now.tv_sec - m_moveStartTime.tv_sec) * 1000 +
+                          (now.tv_usec - m_moveStartTime.tv_usec) / 1000;
+
+    int &remaining = m_clockRemainingMSecs[player2Index(m_board->getCurrentPlayer())];
+    remaining = std::max(remaining - elapsedMS, 0) + m_clockIncrementMSecs;
+}
+
 int GameControl::doMove(Move m)
 {
     assert(m_gameState.state == GameState::Moving);
@@ -101,6 +130,8 @@ int GameControl::doMove(Move m)
     m_partialMoveActive = false;
     m_signal_endMove(getCurrentPlayerInterface());
 
+    advanceClock();
+
     // add copy of current board to history end
     m_history.resize(m_currentHistoryPos + 1); // delete future history
     m_movelog.resize(m_currentHistoryPos);     // delete future history
@@ -137,7 +168,7 @@ int GameControl::doMove(Move m)
         m_winner = m_gameState.SUBSTATE_Winner;
 
         for (int i = 0; i < 2; i++)         {
-            m_player[i]->notifyWinner(m_winner);
+            m_player[i]->notifyWinner(m_winner, *this);
         }
 
         m_signal_gameOver(m_winner);
@@ -165,6 +196,10 @@ void GameControl::startNextMove()
     // initiate next player's move
 
     m_moveID++;
+
+    gettimeofday(&m_moveStartTime, NULL);
+    getCurrentPlayerInterface()->setGameClock(m_clockTotalMSecs ? m_clockRemainingMSecs[player2Index(p)] : 0,
+                                              m_clockIncrementMSecs);
     getCurrentPlayerInterface()->startMove(getCurrentBoard(), m_moveID);
 
     m_signal_startMove(getCurrentPlayerInterface());
@@ -242,6 +277,8 @@ void GameControl::resetGame()
 
     m_board->reset(m_ruleSpec->nPieces);
 
+    m_clockRemainingMSecs[0] = m_clockRemainingMSecs[1] = m_clockTotalMSecs;
+
     m_gameHasEnded = false;
     m_gameState.state = GameState::Idle;
 
@@ -20,6 +20,7 @@
 #define CONTROL_HH
 
 #include <string>
+#include <sys/time.h>
 #include <boost/shared_ptr.hpp>
 #include <boost/signals2.hpp>
 
@@ -80,6 +81,18 @@ public:
         return m_ruleSpec;
     }
 
+    /* Play with a game clock. Each player starts with 'totalMSecs' and gains 'incrementMSecs'
+       after each of its moves. The remaining time is passed to the player at the start of
+       each move, such that the AI can plan its thinking time. The clock does not decide
+       the game and is not restored by undo. Set 'totalMSecs' to zero to switch it off.
+       The clocks are restarted. */
+    void setGameClock(int totalMSecs, int incrementMSecs);
+
+    int getClockRemaining_msec(Player p) const
+    {
+        return m_clockRemainingMSecs[player2Index(p)];
+    }
+
     // --- global game control ---
 
     void resetGame();
@@ -217,6 +230,15 @@ private:
 
     int m_moveID;
 
+    // game clock
+
+    int m_clockTotalMSecs; // zero without clock
+    int m_clockIncrementMSecs;
+    int m_clockRemainingMSecs[2];
+    struct timeval m_moveStartTime;
+
+    void advanceClock();
+
     bool m_partialMoveActive;
     Board m_partialMoveBoard;
 
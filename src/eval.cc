@@ -0,0 +1,219 @@
+/***************************************************************************
+  This file is part of Morris.
+  Copyright (C) 2009 Dirk Farin <dirk.farin@gmail.com>
+
+  Morris is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+***************************************************************************/
+
+
+#include "eval.hh"
+
+/* The evaluation parameters. The default weights of material, freedom, and mills
+   equal the former phase-independent weights, and the other terms are switched off,
+   such that the default play is unchanged. Board-specific parameters computed with
+   morris-tune are added to the table below.
+ */
+static const EvalParams defaultParams =
+{
+    {
+        //  material freedom mills  open   double blocked toSet
+        {   1.0,     0.2,    0.8,   0.0,   0.0,   0.0,    0.0 }, // placing
+        {   1.0,     0.2,    0.8,   0.0,   0.0,   0.0,    0.0 }, // moving
+        {   1.0,     0.2,    0.8,   0.0,   0.0,   0.0,    0.0 }  // flying
+    }
+};
+
+static const struct
+{
+    BoardSpec::BoardPreset board;
+    EvalParams params;
+} boardParams[] =
+{
+    { BoardSpec::Board_Unknown } // end of table
+};
+
+const EvalParams &EvalParams::forBoard(BoardSpec::BoardPreset board)
+{
+    for (int i = 0; boardParams[i].board != BoardSpec::Board_Unknown; i++) {
+        if (boardParams[i].board == board)
+            return boardParams[i].params;
+    }
+
+    return defaultParams;
+}
+
+Evaluation::Evaluation()
+{
+}
+
+void Evaluation::setRules(rulespec_ptr rules)
+{
+    m_rules = rules;
+
+    const BoardSpec &boardSpec = *rules->boardSpec;
+
+    m_millMask.resize(boardSpec.nMills());
+    for (int i = 0; i < boardSpec.nMills(); i++) {
+        const MillPosVector &mill = boardSpec.getMill(i);
+
+        m_millMask[i] = 0;
+        for (int k = 0; k < mill.size(); k++)
+            m_millMask[i] |= positionBit(mill[k]);
+    }
+
+    for (int p = 0; p < boardSpec.nPositions(); p++) {
+        const NeighborVector &neighbors = boardSpec.getNeighbors(p);
+
+        m_neighborMask[p] = 0;
+        for (int k = 0; k < neighbors.size(); k++)
+            m_neighborMask[p] |= positionBit(neighbors[k]);
+    }
+}
+
+GamePhase Evaluation::getPhase(const Board &board) const
+{
+    if (board.getNPiecesToSet() > 0)
+        return Phase_Placing;
+
+    if (m_rules->mayJump && board.getNPiecesLeft() == 3)
+        return Phase_Flying;
+
+    return Phase_Moving;
+}
+
+bool Evaluation::isBlocked(const Board &pos) const
+{
+    const Player me = pos.getCurrentPlayer();
+
+    if (pos.getNPiecesOnBoard(me) == 0 || pos.getNPiecesToSet(me) > 0)
+        return false;
+    if (m_rules->mayJump && pos.getNPiecesLeft(me) == 3)
+        return false;
+
+    const PositionBits empty = ~(pos.getPieceBits(me) | pos.getPieceBits(opponent(me)));
+
+    for (PositionBits bits = pos.getPieceBits(me); bits; bits &= bits - 1) {
+        if (m_neighborMask[firstPosition(bits)] & empty)
+            return false;
+    }
+
+    return true;
+}
+
+bool Evaluation::features(const Board &pos, float feature[Term_NTERMS]) const
+{
+    const Player me = pos.getCurrentPlayer();
+    const Player other = opponent(me);
+
+    const PositionBits mine = pos.getPieceBits(me);
+    const PositionBits theirs = pos.getPieceBits(other);
+    const PositionBits empty = ~(mine | theirs);
+
+    // ========== material ==========
+
+    feature[Term_Material] = pos.getNPiecesLeft(me) - pos.getNPiecesLeft(other);
+    feature[Term_PiecesToSet] = pos.getNPiecesToSet(me) - pos.getNPiecesToSet(other);
+
+    // ========== freedom ==========
+
+    int myFreedom = 0, myBlocked = 0;
+    for (PositionBits bits = mine; bits; bits &= bits - 1) {
+        const int f = countPositions(m_neighborMask[firstPosition(bits)] & empty);
+        myFreedom += f;
+        myBlocked += (f == 0);
+    }
+
+    int oppFreedom = 0, oppBlocked = 0;
+    for (PositionBits bits = theirs; bits; bits &= bits - 1) {
+        const int f = countPositions(m_neighborMask[firstPosition(bits)] & empty);
+        oppFreedom += f;
+        oppBlocked += (f == 0);
+    }
+
+    // Note: consider special case at start of game: no pieces on the pos -> no freedom.
+
+    if (myFreedom == 0 &&
+        pos.getNPiecesOnBoard(me) > 0) {
+        if (m_rules->mayJump && pos.getNPiecesLeft(me) == 3) {
+        } else if (pos.getNPiecesToSet(me) > 0) {
+        } else {
+            return false;
+        }
+    }
+
+    feature[Term_Freedom] = myFreedom - oppFreedom;
+    feature[Term_BlockedPieces] = oppBlocked - myBlocked;
+
+    // ========== mills ==========
+
+    int myMills = 0, otherMills = 0;
+    PositionBits myClosed = 0, otherClosed = 0;
+
+    for (size_t i = 0; i < m_millMask.size(); i++) {
+        const PositionBits mill = m_millMask[i];
+
+        /**/ if ((mill & mine) == mill) {
+            myMills++;
+            myClosed |= mill;
+        } else if ((mill & theirs) == mill) {
+            otherMills++;
+            otherClosed |= mill;
+        }
+    }
+
+    int myOpen = 0, otherOpen = 0;
+    int myDouble = 0, otherDouble = 0;
+
+    for (size_t i = 0; i < m_millMask.size(); i++) {
+        const PositionBits mill = m_millMask[i];
+
+        if ((mill & empty) == 0 || countPositions(mill & empty) != 1)
+            continue;
+
+        const int emptyPos = firstPosition(mill & empty);
+
+        /**/ if ((mill & theirs) == 0) {
+            myOpen++;
+            if (m_neighborMask[emptyPos] & mine & myClosed & ~mill)
+                myDouble++;
+        } else if ((mill & mine) == 0) {
+            otherOpen++;
+            if (m_neighborMask[emptyPos] & theirs & otherClosed & ~mill)
+                otherDouble++;
+        }
+    }
+
+    feature[Term_Mills] = myMills - otherMills;
+    feature[Term_OpenMills] = myOpen - otherOpen;
+    feature[Term_DoubleMills] = myDouble - otherDouble;
+
+    return true;
+}
+
+const char *Evaluation::termName(EvalTerm t)
+{
+    static const char *names[Term_NTERMS] =
+    {
+        "material", "freedom", "mills", "open-mills", "double-mills", "blocked", "pieces-to-set"
+    };
+
+    return names[t];
+}
+
+const char *Evaluation::phaseName(GamePhase p)
+{
+    static const char *names[Phase_NPHASES] = { "placing", "moving", "flying" };
+
+    return names[p];
+}
@@ -0,0 +1,90 @@
+/***************************************************************************
+  This file is part of Morris.
+  Copyright (C) 2009 Dirk Farin <dirk.farin@gmail.com>
+
+  Morris is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+***************************************************************************/
+
+
+#ifndef EVAL_HH
+#define EVAL_HH
+
+#include "rules.hh"
+
+#include <vector>
+
+/* The game phase of the player to move. Each phase has its own evaluation weights.
+ */
+enum GamePhase
+{
+    Phase_Placing, // the player still has pieces to set
+    Phase_Moving,
+    Phase_Flying, // the player is down to three pieces and may jump
+    Phase_NPHASES
+};
+
+/* The terms of the static evaluation. Each term is the difference between the
+   player to move and the opponent. To add a term, append it here, compute it in
+   Evaluation::features(), and add its weights to the parameter tables in eval.cc.
+ */
+enum EvalTerm
+{
+    Term_Material,      // pieces on the board and still to set
+    Term_Freedom,       // empty neighbors of all pieces
+    Term_Mills,         // closed mills
+    Term_OpenMills,     // two pieces of a mill with the third position empty
+    Term_DoubleMills,   // open mills that can be closed by a piece of a closed mill
+    Term_BlockedPieces, // pieces without empty neighbor (counted positive for the opponent's pieces)
+    Term_PiecesToSet,   // pieces not set yet
+    Term_NTERMS
+};
+
+struct EvalParams
+{
+    float weight[Phase_NPHASES][Term_NTERMS];
+
+    // The parameters for the board, or the default parameters if there are no specific ones.
+    static const EvalParams &forBoard(BoardSpec::BoardPreset);
+};
+
+/* The static evaluation, based on bit-sets of the pieces and precomputed position
+   sets for the mills and neighborhoods of the board.
+ */
+class Evaluation
+{
+public:
+    Evaluation();
+
+    void setRules(rulespec_ptr);
+
+    GamePhase getPhase(const Board &) const;
+
+    /* Compute all terms (from the view of the player to move). Returns false if the
+       position is lost for the player to move, because all pieces are blocked. */
+    bool features(const Board &, float feature[Term_NTERMS]) const;
+
+    // Only the lost-position check of features(), for other evaluators.
+    bool isBlocked(const Board &) const;
+
+    static const char *termName(EvalTerm);
+    static const char *phaseName(GamePhase);
+
+private:
+    rulespec_ptr m_rules;
+
+    std::vector<PositionBits> m_millMask;
+    PositionBits m_neighborMask[MAXPOSITIONS];
+};
+
+#endif
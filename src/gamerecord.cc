@@ -0,0 +1,270 @@
+/***************************************************************************
+  This file is part of Morris.
+  Copyright (C) 2009 Dirk Farin <dirk.farin@gmail.com>
+
+  Morris is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+***************************************************************************/
+
+
+#include "gamerecord.hh"
+
+#include <string.h>
+
+static const char MAGIC[8] = { 'M', 'O', 'R', 'R', 'I', 'S', 'G', 'R' };
+static const int VERSION = 1;
+
+enum
+{
+    HEADER_SIZE = 8 + 4 + 4 + 8,
+    NO_POSITION = 255,
+    FLAG_GAMESTART = 0x80
+};
+
+static void putNumber(unsigned char *&p, unsigned long long v, int nBytes)
+{
+    for (int i = 0; i < nBytes; i++) {
+        *p++ = (v >> (8 * i)) & 0xFF;
+    }
+}
+
+static unsigned long long getNumber(const unsigned char *&p, int nBytes)
+{
+    unsigned long long v = 0;
+    for (int i = 0; i < nBytes; i++) {
+        v |= (unsigned long long)(*p++) << (8 * i);
+    }
+    return v;
+}
+
+static void packHeader(unsigned char buf[HEADER_SIZE], Key rulesKey)
+{
+    memcpy(buf, MAGIC, sizeof(MAGIC));
+
+    unsigned char *p = buf + sizeof(MAGIC);
+    putNumber(p, VERSION, 4);
+    putNumber(p, RECORD_SIZE, 4);
+    putNumber(p, rulesKey, 8);
+}
+
+static bool unpackHeader(const unsigned char buf[HEADER_SIZE], Key &rulesKey)
+{
+    if (memcmp(buf, MAGIC, sizeof(MAGIC)) != 0) {
+        return false;
+    }
+
+    const unsigned char *p = buf + sizeof(MAGIC);
+    const int version = getNumber(p, 4);
+    const int recordSize = getNumber(p, 4);
+    rulesKey = getNumber(p, 8);
+
+    return version == VERSION && recordSize == RECORD_SIZE;
+}
+
+// --- writer ---
+
+GameRecordWriter::GameRecordWriter()
+    : m_fh(NULL)
+{
+}
+
+GameRecordWriter::~GameRecordWriter()
+{
+    close();
+}
+
+bool GameRecordWriter::open(const std::string &filename, Key rulesKey)
+{
+    close();
+
+    unsigned char header[HEADER_SIZE];
+
+    // check the header of an existing file
+
+    FILE *fh = fopen(filename.c_str(), "rb");
+    if (fh != NULL) {
+        const bool empty = (fread(header, 1, HEADER_SIZE, fh) == 0);
+        fclose(fh);
+
+        Key fileRulesKey;
+        if (!empty && (!unpackHeader(header, fileRulesKey) || fileRulesKey != rulesKey)) {
+            return false;
+        }
+
+        if (!empty) {
+            m_fh = fopen(filename.c_str(), "ab");
+            return m_fh != NULL;
+        }
+    }
+
+    m_fh = fopen(filename.c_str(), "wb");
+    if (m_fh == NULL) {
+        return false;
+    }
+
+    packHeader(header, rulesKey);
+    return fwrite(header, HEADER_SIZE, 1, m_fh) == 1;
+}
+
+void GameRecordWriter::close()
+{
+    if (m_fh) {
+        fclose(m_fh);
+        m_fh = NULL;
+    }
+}
+
+bool GameRecordWriter::writeGame(const std::vector<PositionRecord> &game)
+{
+    if (m_fh == NULL || game.empty()) {
+        return m_fh != NULL;
+    }
+
+    std::vector<unsigned char> buf(game.size() * RECORD_SIZE);
+    unsigned char *p = &buf[0];
+
+    for (size_t i = 0; i < game.size(); i++) {
+        const PositionRecord &r = game[i];
+
+        putNumber(p, r.id, 8);
+        putNumber(p, (unsigned short)(short)r.score, 2);
+
+        *p++ = (r.move.mode == Move::Mode_Set ? NO_POSITION : r.move.oldPos);
+        *p++ = r.move.newPos;
+        for (int t = 0; t < Move::MAXTAKES; t++) {
+            *p++ = (t < r.move.takes.size() ? r.move.takes[t] : NO_POSITION);
+        }
+
+        *p++ = (r.winner + 1) | (i == 0 ? FLAG_GAMESTART : 0);
+    }
+
+    if (fwrite(&buf[0], buf.size(), 1, m_fh) != 1) {
+        return false;
+    }
+
+    return fflush(m_fh) == 0;
+}
+
+// --- reader ---
+
+GameRecordReader::GameRecordReader()
+    : m_fh(NULL),
+    m_rulesKey(0)
+{
+}
+
+GameRecordReader::~GameRecordReader()
+{
+    close();
+}
+
+bool GameRecordReader::open(const std::string &filename)
+{
+    close();
+
+    m_fh = fopen(filename.c_str(), "rb");
+    if (m_fh == NULL) {
+        return false;
+    }
+
+    unsigned char header[HEADER_SIZE];
+    if (fread(header, HEADER_SIZE, 1, m_fh) != 1 || !unpackHeader(header, m_rulesKey)) {
+        close();
+        return false;
+    }
+
+    return true;
+}
+
+void GameRecordReader::close()
+{
+    if (m_fh) {
+        fclose(m_fh);
+        m_fh = NULL;
+    }
+}
+
+bool GameRecordReader::next(PositionRecord &r)
+{
+    unsigned char buf[RECORD_SIZE];
+    if (m_fh == NULL || fread(buf, RECORD_SIZE, 1, m_fh) != 1) {
+        return false;
+    }
+
+    const unsigned char *p = buf;
+    r.id = getNumber(p, 8);
+    r.score = (short)getNumber(p, 2);
+
+    const int oldPos = *p++;
+    const int newPos = *p++;
+
+    if (oldPos == NO_POSITION) {
+        r.move.setMove_Set(newPos);
+    } else {
+        r.move.setMove_Move(oldPos, newPos);
+    }
+
+    r.move.takes.clear();
+    for (int t = 0; t < Move::MAXTAKES; t++, p++) {
+        if (*p != NO_POSITION) {
+            r.move.addTake(*p);
+        }
+    }
+
+    r.winner = Player((*p & 3) - 1);
+    r.gameStart = (*p & FLAG_GAMESTART) != 0;
+
+    return true;
+}
+
+// --- experience ---
+
+static void addGame(const std::vector<BoardID> &boards, Player winner, Experience &experience)
+{
+    if (!boards.empty() && winner != PL_None) {
+        experience.addGame(boards, winner);
+    }
+}
+
+bool importGameRecords(const std::string &filename, const RuleSpec &rules, Experience &experience)
+{
+    GameRecordReader reader;
+    if (!reader.open(filename)) {
+        return false;
+    }
+
+    if (reader.getRulesKey() != rules.getRulesKey()) {
+        return true;
+    }
+
+    std::vector<BoardID> boards;
+    Player winner = PL_None;
+
+    PositionRecord r;
+    while (reader.next(r)) {
+        if (r.gameStart) {
+            addGame(boards, winner, experience);
+            boards.clear();
+        }
+
+        Board board;
+        rules.getBoardFromID(r.id, board);
+
+        boards.push_back(rules.getBoardID_Symmetric(board));
+        winner = r.winner;
+    }
+
+    addGame(boards, winner, experience);
+
+    return true;
+}
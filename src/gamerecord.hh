@@ -0,0 +1,104 @@
+/***************************************************************************
+  This file is part of Morris.
+  Copyright (C) 2009 Dirk Farin <dirk.farin@gmail.com>
+
+  Morris is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+***************************************************************************/
+
+
+#ifndef GAMERECORD_HH
+#define GAMERECORD_HH
+
+#include "rules.hh"
+#include "score.hh"
+#include "learn.hh"
+
+#include <vector>
+#include <string>
+#include <stdio.h>
+
+/* One position of a recorded game with the move that was played in it.
+ */
+struct PositionRecord
+{
+    BoardID id;     // see RuleSpec::getBoardID()
+    Score score;    // search score, relative to the player to move
+    Move move;      // the move played
+    Player winner;  // result of the game, PL_None for a tie
+    bool gameStart; // first recorded position of a game
+};
+
+/* Game records store the positions of many games (e.g., generated by morris-selfplay)
+   for the offline tools. A file consists of a header with the rules key followed by
+   fixed-size records of RECORD_SIZE bytes, one per position, in the order of the
+   games. All numbers are stored little-endian. A record is packed as:
+
+     bytes  0-7   board ID
+     bytes  8-9   score
+     byte  10     old position of the move (255 when setting a piece)
+     byte  11     new position of the move
+     bytes 12-14  taken pieces (255 for unused entries)
+     byte  15     bits 0-1: winner (0 black, 1 tie, 2 white), bit 7: first position of a game
+ */
+enum
+{
+    RECORD_SIZE = 16
+};
+
+class GameRecordWriter
+{
+public:
+    GameRecordWriter();
+    ~GameRecordWriter();
+
+    /* Open the file for appending. A new file is created if it does not exist.
+       Returns false if the file cannot be written or holds records for other rules. */
+    bool open(const std::string &filename, Key rulesKey);
+    void close();
+
+    // Append the positions of one game. The game-start flag is set for the first position.
+    bool writeGame(const std::vector<PositionRecord> &);
+
+private:
+    FILE *m_fh;
+};
+
+class GameRecordReader
+{
+public:
+    GameRecordReader();
+    ~GameRecordReader();
+
+    // Returns false if the file cannot be read or is no game-record file.
+    bool open(const std::string &filename);
+    void close();
+
+    Key getRulesKey() const
+    {
+        return m_rulesKey;
+    }
+
+    // Read the next position. Returns false at the end of the file.
+    bool next(PositionRecord &);
+
+private:
+    FILE *m_fh;
+    Key m_rulesKey;
+};
+
+/* Add all decided games in the record file to the experience, if they were played
+   with the given rules. Returns false if the file is no game-record file. */
+bool importGameRecords(const std::string &filename, const RuleSpec &, Experience &);
+
+#endif
@@ -137,6 +137,13 @@ void ApplicationGUI_Gtk::startMove()
 {
 }
 
+void ApplicationGUI_Gtk::setSearchInfo(const SearchInfo &info)
+{
+    char buf[100];
+    sprintf(buf, _("depth %d, %lld kN/s"), info.depth, info.nodesPerSecond() / 1000);
+    gtk_progress_bar_set_text(GTK_PROGRESS_BAR(progressbar), buf);
+}
+
 void ApplicationGUI_Gtk::preferencesDialog_Display()
 {
     ::preferencesDialog_Display();
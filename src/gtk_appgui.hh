@@ -46,6 +46,9 @@ public:
         gtk_statusbar_push(GTK_STATUSBAR(statusbar), statusbar_context, str.c_str());
     }
 
+    // show search depth and speed in the progress bar
+    virtual void setSearchInfo(const SearchInfo &info);
+
     void showGameOverDialog(Player winner);
     void enableGameOverDialog(bool flag)
     {
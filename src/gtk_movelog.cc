@@ -22,10 +22,14 @@
 #include "mainapp.hh"
 
 #include <iostream>
+#include <algorithm>
 #include <boost/bind.hpp>
 
 const int PADDING = 10;
 
+// number of changed rows above which the list is detached from the view while updating
+const int DETACH_THRESHOLD = 20;
+
 static gboolean quit_callback(GtkWidget *widget, gpointer data)
 {
     return FALSE;
@@ -39,7 +43,11 @@ gboolean cbMoveLog_gtk_destroy(GtkWidget *widget, gpointer data)
 }
 
 MoveLog_Gtk::MoveLog_Gtk()
+    : m_highlightPly(-1)
 {
+    gdk_color_parse("#c0c0ff", &m_activeColor);
+    gdk_color_parse("#ffffff", &m_passiveColor);
+
     window = gtk_window_new(GTK_WINDOW_TOPLEVEL);
     gtk_window_set_title(GTK_WINDOW(window), _("Move List"));
     gtk_container_set_border_width(GTK_CONTAINER(window), PADDING);
@@ -124,8 +132,31 @@ void MoveLog_Gtk::cbDestroy()
     m_signal_windowClosed();
 }
 
-/* TODO: the refresh is really inefficient, because the complete list is rebuilt, adding the content
-   line by line. Since gtk seems to make a refresh for each line, this is very slow.
+bool MoveLog_Gtk::getRow(int ply, GtkTreeIter *iter)
+{
+    return gtk_tree_model_iter_nth_child(GTK_TREE_MODEL(liststore), iter, NULL, ply / 2);
+}
+
+void MoveLog_Gtk::setCellText(int ply, const std::string &text)
+{
+    GtkTreeIter iter;
+    if (getRow(ply, &iter))     {
+        gtk_list_store_set(liststore, &iter, 1 + ply % 2, text.c_str(), -1);
+    }
+}
+
+void MoveLog_Gtk::setCellHighlight(int ply, bool active)
+{
+    GtkTreeIter iter;
+    if (ply >= 0 && getRow(ply, &iter))     {
+        gtk_list_store_set(liststore, &iter, 4 + 2 * (ply % 2),
+                           (active ? &m_activeColor : &m_passiveColor), -1);
+    }
+}
+
+/* Only the differences to the displayed list are applied. Since new moves are always
+   added at the current history position, a move during the game changes only the
+   last one or two cells and the highlight, independent of the game length.
  */
 void MoveLog_Gtk::refresh()
 {
@@ -133,61 +164,92 @@ void MoveLog_Gtk::refresh()
         return;
     }
 
-    gtk_list_store_clear(liststore);
-
     const GameControl &control = MainApp::app().getControl();
     boardspec_ptr boardspec = control.getBoardSpec();
 
-    GdkColor activeColor, passiveColor;
-    gdk_color_parse("#c0c0ff", &activeColor);
-    gdk_color_parse("#ffffff", &passiveColor);
+    const int nMoves = control.getHistorySize() - 1;
+    const int nRows = nMoves / 2 + 1;
 
-    const bool ended = (control.hasGameEnded());
+    // find the first move that is different from the displayed list
 
-    std::string winner;
-    if (ended)     {
-        if (control.getGameWinner() == PL_None)
-            winner = _("tie");
-        else
-            winner = "+++";
-    }     else
-        winner = "...";
+    int firstChange = std::min(nMoves, int(m_moves.size()));
+
+    if (boardspec != m_boardspec)     {
+        firstChange = 0;
+        m_boardspec = boardspec;
+    }
 
-    for (int ply = 0; ply < control.getHistorySize(); ply += 2)     {
-        Move whitemove;
-        Move blackmove;
+    const int lastMove = control.getHistoryPos() - 1;
+    if (lastMove >= 0 && lastMove < firstChange &&
+        !(m_moves[lastMove] == control.getHistoryMove(lastMove)))     {
+        firstChange = lastMove;
+    }
 
-        std::string whiteStr, blackStr;
+    m_moves.resize(firstChange);
+    for (int ply = firstChange; ply < nMoves; ply++)     {
+        m_moves.push_back(control.getHistoryMove(ply));
+    }
 
-        if (ply < control.getHistorySize() - 1)         {
-            whitemove = control.getHistoryMove(ply);
-            whiteStr = writeMove(whitemove, boardspec);
-        }
+    // detach the list from the view when many rows change
 
-        if (ply == control.getHistorySize() - 1)         {
-            whiteStr = winner;
-        }
+    GtkTreeModel *model = GTK_TREE_MODEL(liststore);
+    const int nOldRows = gtk_tree_model_iter_n_children(model, NULL);
 
-        if (ply + 1 < control.getHistorySize() - 1)         {
-            blackmove = control.getHistoryMove(ply + 1);
-            blackStr = writeMove(blackmove, boardspec);
-        }
+    const bool detach = (std::max(nRows, nOldRows) - firstChange / 2 > DETACH_THRESHOLD);
+    if (detach)     {
+        gtk_tree_view_set_model(GTK_TREE_VIEW(treeview), NULL);
+    }
 
-        if (ply + 1 == control.getHistorySize() - 1)         {
-            blackStr = winner;
-        }
+    // adjust the number of rows
 
-        bool whiteCurrent = (ply == control.getHistoryPos());
-        bool blackCurrent = (ply + 1 == control.getHistoryPos());
+    if (nOldRows > nRows)     {
+        GtkTreeIter iter;
+        gtk_tree_model_iter_nth_child(model, &iter, NULL, nRows);
+        while (gtk_list_store_remove(liststore, &iter))
+            ;
+    }
 
+    for (int row = nOldRows; row < nRows; row++)     {
         GtkTreeIter iter;
         gtk_list_store_append(liststore, &iter);
         gtk_list_store_set(liststore, &iter,
-                           0, ply / 2 + 1,
-                           1, whiteStr.c_str(),
-                           2, blackStr.c_str(),
-                           4, (whiteCurrent ? &activeColor : &passiveColor),
-                           6, (blackCurrent ? &activeColor : &passiveColor),
+                           0, row + 1,
+                           4, &m_passiveColor,
+                           6, &m_passiveColor,
                            -1);
     }
+
+    // rewrite the changed moves and the cells following the last move
+
+    std::string winner;
+    if (control.hasGameEnded())     {
+        if (control.getGameWinner() == PL_None)
+            winner = _("tie");
+        else
+            winner = "+++";
+    }     else
+        winner = "...";
+
+    for (int ply = firstChange; ply < 2 * nRows; ply++)     {
+        if (ply < nMoves)
+            setCellText(ply, writeMove(m_moves[ply], boardspec));
+        else if (ply == nMoves)
+            setCellText(ply, winner);
+        else
+            setCellText(ply, "");
+    }
+
+    // move the highlight to the current position
+
+    if (m_highlightPly != control.getHistoryPos() || firstChange == 0)     {
+        if (m_highlightPly < 2 * nRows)
+            setCellHighlight(m_highlightPly, false);
+
+        m_highlightPly = control.getHistoryPos();
+        setCellHighlight(m_highlightPly, true);
+    }
+
+    if (detach)     {
+        gtk_tree_view_set_model(GTK_TREE_VIEW(treeview), model);
+    }
 }
@@ -20,7 +20,10 @@
 #define GTK_MOVELOG_HH
 
 #include "movelog.hh"
+#include "board.hh"
+#include "boardspec.hh"
 #include <gtk/gtk.h>
+#include <vector>
 
 class MoveLog_Gtk : public MoveLog
 {
@@ -37,6 +40,18 @@ private:
 
     GtkListStore *liststore;
 
+    /* What is currently shown in the list. It is used to update only the rows
+       that changed since the last refresh. */
+    boardspec_ptr m_boardspec;
+    std::vector<Move> m_moves;
+    int m_highlightPly;
+
+    GdkColor m_activeColor, m_passiveColor;
+
+    bool getRow(int ply, GtkTreeIter *);
+    void setCellText(int ply, const std::string &);
+    void setCellHighlight(int ply, bool active);
+
     gulong destroyHandler;
     boost::signals2::connection refreshConnection;
 
@@ -192,6 +192,47 @@ void preferencesDialog_AI()
     gtk_signal_connect(GTK_OBJECT(check_shareTT), "toggled", GTK_SIGNAL_FUNC(cb_aiPref_shareTT), &ai[1]);
     enableDualEvalWeights(&ai[1], !share_TT);
 
+    GtkWidget *check_symmetricTT = gtk_check_button_new_with_label(_("share table entries of symmetric positions"));
+    gtk_toggle_button_set_active(GTK_TOGGLE_BUTTON(check_symmetricTT),
+                                 config->read_bool(config->ai(), ConfigManager::itemComputers_symmetricTTables));
+    gtk_box_pack_start(GTK_BOX(GTK_DIALOG(pref_dialog)->vbox), check_symmetricTT, FALSE, TRUE, PADDING);
+
+    GtkWidget *check_analysisCache = gtk_check_button_new_with_label(_("remember analysis across sessions"));
+    gtk_toggle_button_set_active(GTK_TOGGLE_BUTTON(check_analysisCache),
+                                 config->read_bool(config->ai(), ConfigManager::itemComputers_analysisCache));
+    gtk_box_pack_start(GTK_BOX(GTK_DIALOG(pref_dialog)->vbox), check_analysisCache, FALSE, TRUE, PADDING);
+
+    GtkWidget *check_neuralNetwork = gtk_check_button_new_with_label(_("evaluate with trained neural network"));
+    gtk_toggle_button_set_active(GTK_TOGGLE_BUTTON(check_neuralNetwork),
+                                 config->read_bool(config->ai(), ConfigManager::itemComputers_neuralNetwork));
+    gtk_box_pack_start(GTK_BOX(GTK_DIALOG(pref_dialog)->vbox), check_neuralNetwork, FALSE, TRUE, PADDING);
+
+    GtkWidget *hbox_ttableSize = gtk_hbox_new(FALSE, PADDING);
+    GtkWidget *spin_ttableSize = gtk_spin_button_new_with_range(1.0, 32768.0, 1.0);
+    gtk_spin_button_set_value(GTK_SPIN_BUTTON(spin_ttableSize),
+                              config->read_int(config->ai(), ConfigManager::itemComputers_ttableSize));
+    gtk_box_pack_start(GTK_BOX(hbox_ttableSize), new_label_left(_("transposition table size (MB)")), FALSE, TRUE, 0);
+    gtk_box_pack_start(GTK_BOX(hbox_ttableSize), spin_ttableSize, FALSE, TRUE, 0);
+    gtk_box_pack_start(GTK_BOX(GTK_DIALOG(pref_dialog)->vbox), hbox_ttableSize, FALSE, TRUE, PADDING);
+
+    GtkWidget *hbox_clock = gtk_hbox_new(FALSE, PADDING);
+    GtkWidget *spin_clockMinutes = gtk_spin_button_new_with_range(0.0, 600.0, 1.0);
+    gtk_spin_button_set_value(GTK_SPIN_BUTTON(spin_clockMinutes),
+                              config->read_int(config->ai(), ConfigManager::itemComputers_clockMinutes));
+    GtkWidget *spin_clockIncrement = gtk_spin_button_new_with_range(0.0, 600.0, 1.0);
+    gtk_spin_button_set_value(GTK_SPIN_BUTTON(spin_clockIncrement),
+                              config->read_int(config->ai(), ConfigManager::itemComputers_clockIncrement));
+    gtk_box_pack_start(GTK_BOX(hbox_clock), new_label_left(_("game clock (min, 0=off)")), FALSE, TRUE, 0);
+    gtk_box_pack_start(GTK_BOX(hbox_clock), spin_clockMinutes, FALSE, TRUE, 0);
+    gtk_box_pack_start(GTK_BOX(hbox_clock), new_label_left(_("increment (s)")), FALSE, TRUE, 0);
+    gtk_box_pack_start(GTK_BOX(hbox_clock), spin_clockIncrement, FALSE, TRUE, 0);
+    gtk_box_pack_start(GTK_BOX(GTK_DIALOG(pref_dialog)->vbox), hbox_clock, FALSE, TRUE, PADDING);
+
+    gchar *experienceTxt = g_strdup_printf(_("learned positions: %d"),
+                                           MainApp::app().getExperience().getNEntries());
+    gtk_box_pack_start(GTK_BOX(GTK_DIALOG(pref_dialog)->vbox), new_label_left(experienceTxt), FALSE, TRUE, PADDING);
+    g_free(experienceTxt);
+
     gtk_widget_show_all(pref_dialog);
 
     // can run it
@@ -202,6 +243,24 @@ void preferencesDialog_AI()
         share_TT = gtk_toggle_button_get_active(GTK_TOGGLE_BUTTON(check_shareTT));
         config->store(config->ai(),
                       ConfigManager::itemComputers_shareTTables, share_TT);
+        config->store(config->ai(),
+                      ConfigManager::itemComputers_symmetricTTables,
+                      bool(gtk_toggle_button_get_active(GTK_TOGGLE_BUTTON(check_symmetricTT))));
+        config->store(config->ai(),
+                      ConfigManager::itemComputers_analysisCache,
+                      bool(gtk_toggle_button_get_active(GTK_TOGGLE_BUTTON(check_analysisCache))));
+        config->store(config->ai(),
+                      ConfigManager::itemComputers_neuralNetwork,
+                      bool(gtk_toggle_button_get_active(GTK_TOGGLE_BUTTON(check_neuralNetwork))));
+        config->store(config->ai(),
+                      ConfigManager::itemComputers_ttableSize,
+                      int(gtk_spin_button_get_value(GTK_SPIN_BUTTON(spin_ttableSize))));
+        config->store(config->ai(),
+                      ConfigManager::itemComputers_clockMinutes,
+                      int(gtk_spin_button_get_value(GTK_SPIN_BUTTON(spin_clockMinutes))));
+        config->store(config->ai(),
+                      ConfigManager::itemComputers_clockIncrement,
+                      int(gtk_spin_button_get_value(GTK_SPIN_BUTTON(spin_clockIncrement))));
 
         for (int c = 0; c < 2; c++)         {
             MainApp::app().getTTable(c)->clear(); // TODO: in fact, we only have to clear the table, if we changed a crucial parameter
@@ -24,16 +24,6 @@
 
 #include <gtk/gtk.h>
 
-static gboolean cb_setProgress(gpointer p)
-{
-    float *progress = (float *)p;
-
-    MainApp::app().getApplicationGUI()->setProgress(*progress);
-    delete progress;
-
-    return FALSE;
-}
-
 static gboolean cb_setStatusbar(gpointer p)
 {
     std::string *str = (std::string *)p;
@@ -44,29 +34,137 @@ static gboolean cb_setStatusbar(gpointer p)
     return FALSE;
 }
 
-struct MoveData
+struct MoveMessage
 {
+    MoveMessage(const Move &m, int id) : move(m), gameID(id)
+    {
+    }
+
     Move move;
     int gameID;
 };
 
-static gboolean cb_doMove(gpointer p)
+static gboolean cb_visualizeMove(gpointer p)
 {
-    MoveData *m = (MoveData *)p;
+    MoveMessage *msg = (MoveMessage *)p;
 
     gdk_threads_enter(); // see gtk_boardgui.cc for why this is needed
-    MainApp::app().visualizeMove(m->move, m->gameID);
+    MainApp::app().visualizeMove(msg->move, msg->gameID);
     gdk_threads_leave();
-    delete m;
+    delete msg;
 
     return FALSE;
 }
 
 // ---------------------------------------------------------------------------
 
+/* Bounded lock-free queue for the messages from the search threads to the main loop.
+   Usually there is only one producer, but a cancelled search may still be running
+   when the next one starts. Hence, the write position is reserved with an atomic
+   compare-and-exchange, and each cell carries a sequence number that tells whether
+   it is free (== position) or filled (== position+1). There is one consumer, the
+   drain function in the main loop.
+   Producers never wait for the consumer, because the main loop may itself be waiting
+   for a search thread to end. Instead, MOVE_HEADROOM cells are kept free for moves.
+ */
+class MessageQueue
+{
+public:
+    enum { SIZE = 64 }; // must be a power of two
+    enum { MOVE_HEADROOM = 4 }; // cells that only moves may use
+
+    enum MessageType
+    {
+        Msg_Move,
+        Msg_ThinkingInfo,
+        Msg_SearchInfo
+    };
+
+    struct Message
+    {
+        volatile gint sequence;
+
+        MessageType type;
+        Move move;
+        int gameID;
+        std::string text; // keeps its capacity, so there is no allocation after a few messages
+        SearchInfo info;
+    };
+
+    MessageQueue() : m_head(0), m_tail(0)
+    {
+        for (int i = 0; i < SIZE; i++)
+            m_cells[i].sequence = i;
+    }
+
+    /* Reserve a cell for writing, such that at least 'headroom' more cells remain free.
+       Returns NULL when the queue is full. */
+    Message *reserve(gint *pos, int headroom)
+    {
+        for (;;) {
+            *pos = g_atomic_int_get(&m_head);
+            Message &cell = m_cells[*pos & (SIZE - 1)];
+
+            // the last cell of the headroom is free iff all cells before it are free
+            if (headroom > 0) {
+                const Message &last = m_cells[(*pos + headroom) & (SIZE - 1)];
+                if (g_atomic_int_get(&last.sequence) - (*pos + headroom) < 0)
+                    return NULL;
+            }
+
+            gint diff = g_atomic_int_get(&cell.sequence) - *pos;
+            if (diff == 0) {
+                if (g_atomic_int_compare_and_exchange(&m_head, *pos, *pos + 1))
+                    return &cell;
+            } else if (diff < 0) {
+                return NULL;
+            }
+        }
+    }
+
+    void publish(Message *cell, gint pos)
+    {
+        g_atomic_int_set(&cell->sequence, pos + 1);
+    }
+
+    // Get the next message (consumer only). Returns NULL when the queue is empty.
+    Message *front()
+    {
+        Message &cell = m_cells[m_tail & (SIZE - 1)];
+        if (g_atomic_int_get(&cell.sequence) != m_tail + 1)
+            return NULL;
+
+        return &cell;
+    }
+
+    void pop(Message *cell)
+    {
+        g_atomic_int_set(&cell->sequence, m_tail + SIZE);
+        m_tail++;
+    }
+
+private:
+    Message m_cells[SIZE];
+
+    volatile gint m_head;
+    gint m_tail;
+};
+
+// ---------------------------------------------------------------------------
+
+/* Messages are not forwarded individually, but collected and handled in one drain
+   callback per frame. Progress and thinking information are only shown with their
+   newest value, moves and search statistics are all handled in order.
+ */
 class ThreadTunnel_Gtk : public ThreadTunnel
 {
 public:
+    enum { DRAIN_INTERVAL_MS = 20 };
+
+    ThreadTunnel_Gtk() : m_progress(-1), m_drainPending(0), m_shownProgress(-1)
+    {
+    }
+
     void setStatusbar(const char *buf)
     {
         g_idle_add(cb_setStatusbar, new std::string(buf));
@@ -74,42 +172,141 @@ public:
 
     void setProgress(float progress)
     {
-        float *p = new float;
-        *p = progress;
-
-        g_idle_add(cb_setProgress, p);
+        g_atomic_int_set(&m_progress, int(progress * PROGRESS_SCALE));
+        requestDrain();
     }
 
     void doMove(Move m, int gameID)
     {
-        MoveData *md = new MoveData;
-        md->move = m;
-        md->gameID = gameID;
-
-        g_idle_add(cb_doMove, md);
+        MessageQueue::Message *msg;
+        gint pos;
+
+        /* Moves must not be lost. If even the headroom is used up, the move is passed
+           in an idle callback of its own, which may overtake the queued messages. */
+        if ((msg = m_queue.reserve(&pos, 0)) == NULL) {
+            g_idle_add(cb_visualizeMove, new MoveMessage(m, gameID));
+            requestDrain();
+            return;
+        }
+
+        msg->type = MessageQueue::Msg_Move;
+        msg->move = m;
+        msg->gameID = gameID;
+        m_queue.publish(msg, pos);
+
+        requestDrain();
     }
 
     void showThinkingInfo(const std::string &str)
     {
-        class IdleFunc_showThinking : public IdleFunc
-        {
-        public:
-            IdleFunc_showThinking(const std::string &s) : m_string(s)
-            {
-            }
+        MessageQueue::Message *msg;
+        gint pos;
 
-            void operator()()
-            {
-                MainApp::app().setThinkingInfo(m_string);
-            }
+        // when the queue is full, the information is outdated anyway
+        if ((msg = m_queue.reserve(&pos, MessageQueue::MOVE_HEADROOM)) == NULL) {
+            return;
+        }
+
+        msg->type = MessageQueue::Msg_ThinkingInfo;
+        msg->text = str;
+        m_queue.publish(msg, pos);
 
-            std::string m_string;
-        };
+        requestDrain();
+    }
+
+    void reportSearchInfo(const SearchInfo &info)
+    {
+        MessageQueue::Message *msg;
+        gint pos;
+
+        if ((msg = m_queue.reserve(&pos, MessageQueue::MOVE_HEADROOM)) == NULL) {
+            return;
+        }
+
+        msg->type = MessageQueue::Msg_SearchInfo;
+        msg->info = info;
+        m_queue.publish(msg, pos);
 
-        IdleFunc::install(new IdleFunc_showThinking(str));
+        requestDrain();
     }
+
+    void drain();
+
+private:
+    enum { PROGRESS_SCALE = 10000 };
+
+    MessageQueue m_queue;
+    volatile gint m_progress;     // scaled by PROGRESS_SCALE, -1 if never set
+    volatile gint m_drainPending; // 1 while a drain callback is installed
+
+    // only used in the main loop
+
+    gint m_shownProgress;
+    std::string m_thinkingInfo;
+
+    void requestDrain();
 };
 
+static gboolean cb_drain(gpointer p)
+{
+    ((ThreadTunnel_Gtk *)p)->drain();
+    return FALSE;
+}
+
+void ThreadTunnel_Gtk::requestDrain()
+{
+    if (g_atomic_int_compare_and_exchange(&m_drainPending, 0, 1)) {
+        g_timeout_add(DRAIN_INTERVAL_MS, cb_drain, this);
+    }
+}
+
+void ThreadTunnel_Gtk::drain()
+{
+    // messages arriving from now on need a new drain callback
+    g_atomic_int_set(&m_drainPending, 0);
+
+    gint progress = g_atomic_int_get(&m_progress);
+    if (progress != m_shownProgress && progress >= 0) {
+        m_shownProgress = progress;
+        MainApp::app().getApplicationGUI()->setProgress(float(progress) / PROGRESS_SCALE);
+    }
+
+    bool newThinkingInfo = false;
+
+    MessageQueue::Message *msg;
+    while ((msg = m_queue.front()) != NULL) {
+        if (msg->type == MessageQueue::Msg_ThinkingInfo) {
+            m_thinkingInfo.swap(msg->text);
+            newThinkingInfo = true;
+            m_queue.pop(msg);
+        } else if (msg->type == MessageQueue::Msg_SearchInfo) {
+            SearchInfo info = msg->info;
+            m_queue.pop(msg);
+
+            MainApp::app().setSearchInfo(info);
+        } else {
+            Move move = msg->move;
+            int gameID = msg->gameID;
+            m_queue.pop(msg);
+
+            // keep the order of thinking information and moves
+
+            if (newThinkingInfo) {
+                MainApp::app().setThinkingInfo(m_thinkingInfo);
+                newThinkingInfo = false;
+            }
+
+            gdk_threads_enter(); // see gtk_boardgui.cc for why this is needed
+            MainApp::app().visualizeMove(move, gameID);
+            gdk_threads_leave();
+        }
+    }
+
+    if (newThinkingInfo) {
+        MainApp::app().setThinkingInfo(m_thinkingInfo);
+    }
+}
+
 static ThreadTunnel_Gtk guicb_gtk;
 
 ThreadTunnel &getThreadTunnel_Gtk()
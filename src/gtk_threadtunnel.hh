@@ -24,4 +24,3 @@
 ThreadTunnel &getThreadTunnel_Gtk();
 
 #endif
-#endif
@@ -27,18 +27,16 @@
 
 #include <cairo/cairo.h>
 
-extern gint animation_timer(gpointer obj);
+extern gint render_frame(gpointer obj);
 
+// redraw an area into the offscreen buffer and copy it to the window
 void BoardGUI_GtkCairo::expose_area_rect(int x0, int y0, int w, int h)
 {
     if (offscreenBuffer == NULL) {
         return;
     }
 
-    if (boardGfxInvalid) {
-        draw_board(x0, y0, w, h);
-        boardGfxInvalid = false;
-    }
+    draw_board(x0, y0, w, h);
 
     gdk_draw_drawable(drawingArea->window,
                       drawingArea->style->fg_gc[GTK_WIDGET_STATE(drawingArea)],
@@ -50,16 +48,94 @@ void BoardGUI_GtkCairo::expose_area_rect(int x0, int y0, int w, int h)
 
 void BoardGUI_GtkCairo::redrawBoard()
 {
-    boardGfxInvalid = true;
+    invalidateRect(NULL);
+}
+
+void BoardGUI_GtkCairo::invalidateRect(const GdkRectangle *rect)
+{
+    if (rect) {
+        gdk_region_union_with_rect(dirtyRegion, rect);
+    } else {
+        GdkRectangle all;
+        all.x = 0;
+        all.y = 0;
+        all.width = drawingArea->allocation.width;
+        all.height = drawingArea->allocation.height;
+        gdk_region_union_with_rect(dirtyRegion, &all);
+    }
 
-    gdk_window_invalidate_rect(drawingArea->window, NULL, false);
+    scheduleFrame();
+}
+
+void BoardGUI_GtkCairo::scheduleFrame()
+{
+    if (frameTimer == 0) {
+        frameTimer = g_timeout_add(1000 / MAX_FRAME_RATE, render_frame, this);
+    }
+}
+
+void BoardGUI_GtkCairo::paintDirtyRegion()
+{
+    if (offscreenBuffer == NULL || gdk_region_empty(dirtyRegion)) {
+        return;
+    }
+
+    GdkRectangle *rects;
+    gint nRects;
+    gdk_region_get_rectangles(dirtyRegion, &rects, &nRects);
+
+    for (int i = 0; i < nRects; i++) {
+        expose_area_rect(rects[i].x, rects[i].y, rects[i].width, rects[i].height);
+    }
+
+    g_free(rects);
+
+    gdk_region_destroy(dirtyRegion);
+    dirtyRegion = gdk_region_new();
+}
+
+/* Advance the animations and repaint everything that was invalidated since the
+   last frame. The timer is kept alive as long as animations are running. */
+gint BoardGUI_GtkCairo::cb_render_frame()
+{
+    while (!animation.empty()) {
+        bool stop = animation[0]->action(*this);
+        if (stop) {
+            for (int i = 1; i < animation.size(); i++)
+                animation[i - 1] = animation[i];
+
+            animation.pop_back();
+        } else {
+            break;
+        }
+    }
+
+    paintDirtyRegion();
+
+    if (animation.empty()) {
+        frameTimer = 0;
+        return false;
+    } else {
+        return true;
+    }
 }
 
 // this func is used when an area of the window is uncovered
 void BoardGUI_GtkCairo::cb_expose_area(GtkWidget *widget, GdkEventExpose *event)
 {
-    expose_area_rect(event->area.x, event->area.y,
-                     event->area.width, event->area.height);
+    if (offscreenBuffer == NULL) {
+        return;
+    }
+
+    // The offscreen buffer is up to date except for the dirty region,
+    // which will be repainted in the next frame.
+
+    gdk_draw_drawable(drawingArea->window,
+                      drawingArea->style->fg_gc[GTK_WIDGET_STATE(drawingArea)],
+                      offscreenBuffer,
+                      event->area.x, event->area.y,
+                      event->area.x, event->area.y,
+                      event->area.width, event->area.height);
 }
 
 // this func is used when an area of the window is reconfigured
@@ -80,7 +156,7 @@ void BoardGUI_GtkCairo::cb_realize_area(GtkWidget *widget)
 
     resetDisplay();
 
-    draw_board(0, 0, drawingArea->allocation.width, drawingArea->allocation.height);
+    paintDirtyRegion();
 }
 
 void BoardGUI_GtkCairo::resetDisplay()
@@ -89,6 +165,9 @@ void BoardGUI_GtkCairo::resetDisplay()
                  drawingArea->allocation.height,
                  options);
 
+    invalidateBoardLayer();
+    invalidatePieceSprites();
+
     changeGfxState(getGfxState());
     redrawBoard();
 }
@@ -110,8 +189,7 @@ void BoardGUI_GtkCairo::invalidatePiecePos(Point2D pos_inUnits, float extraRadiu
           << rect.width << ";" << rect.height << "\n";
     */
 
-    gdk_window_invalidate_rect(drawingArea->window, &rect, false);
-    boardGfxInvalid = true;
+    invalidateRect(&rect);
 }
 
 void BoardGUI_GtkCairo::invalidateHoverAtPos(Position p)
@@ -123,19 +201,50 @@ void BoardGUI_GtkCairo::invalidateHoverAtPos(Position p)
     invalidatePiecePos(pt, 1.0 / 7 / 2);
 }
 
+void BoardGUI_GtkCairo::invalidateHint()
+{
+    boardspec_ptr board = MainApp::app().getControl().getBoardSpec();
+
+    invalidatePiecePos(board->getPositionLocation(m_hint.newPos));
+
+    if (m_hint.mode == Move::Mode_Move) {
+        // bounding box of the arrow
+
+        Point2D p1 = geom.board2Pixel(board->getPositionLocation(m_hint.oldPos));
+        Point2D p2 = geom.board2Pixel(board->getPositionLocation(m_hint.newPos));
+        float radius = geom.getPieceRadiusInPixels();
+
+        GdkRectangle rect;
+        rect.x = std::min(p1.x, p2.x) - radius - 2;
+        rect.y = std::min(p1.y, p2.y) - radius - 2;
+        rect.width = fabs(p1.x - p2.x) + 2 * radius + 5;
+        rect.height = fabs(p1.y - p2.y) + 2 * radius + 5;
+        invalidateRect(&rect);
+    }
+
+    for (int i = 0; i < m_hint.takes.size(); i++) {
+        invalidatePiecePos(board->getPositionLocation(m_hint.takes[i]));
+    }
+}
+
 void BoardGUI_GtkCairo::showHint(const Move &hint)
 {
+    if (m_showHint) {
+        invalidateHint();
+    }
+
     m_hint = hint;
     m_showHint = true;
 
-    redrawBoard();
+    invalidateHint();
 }
 
 void BoardGUI_GtkCairo::removeHint()
 {
-    m_showHint = false;
-
-    redrawBoard();
+    if (m_showHint) {
+        m_showHint = false;
+        invalidateHint();
+    }
 }
 
 // ===== drawing the board ====
@@ -153,8 +262,7 @@ bool Animation_RemovePiece::action(BoardGUI_GtkCairo &gui)
 {
     if (elapsedTimeMS() >= durationMS) {
         gui.hidePos.push_back(pos);
-        gui.boardGfxInvalid = true;
-        gdk_window_invalidate_rect(gui.drawingArea->window, NULL, false);
+        gui.invalidatePiecePos(MainApp::app().getControl().getBoardSpec()->getPositionLocation(pos));
         return true;
     } else
         return false;
@@ -189,7 +297,6 @@ bool Animation_MoveOverlay::action(BoardGUI_GtkCairo &gui)
         gui.overlay[overlayIdx].coordinate = endPos;
 
         gui.invalidatePiecePos(endPos);
-        gui.boardGfxInvalid = true;
 
         return true;
     } else {
@@ -201,7 +308,6 @@ bool Animation_MoveOverlay::action(BoardGUI_GtkCairo &gui)
         gui.overlay[overlayIdx].coordinate = c;
 
         gui.invalidatePiecePos(c);
-        gui.boardGfxInvalid = true;
 
         return false;
     }
@@ -241,23 +347,6 @@ bool Animation_DoMove::action(BoardGUI_GtkCairo &gui)
     return true;
 }
 
-gint BoardGUI_GtkCairo::cb_animation_timer()
-{
-    while (!animation.empty()) {
-        bool stop = animation[0]->action(*this);
-        if (stop) {
-            for (int i = 1; i < animation.size(); i++)
-                animation[i - 1] = animation[i];
-
-            animation.pop_back();
-        } else {
-            break;
-        }
-    }
-
-    return !animation.empty();
-}
-
 void BoardGUI_GtkCairo::visualizeMove(const Move &m, int gameID)
 {
     const bool set_moveIn = options.set_moveIn;
@@ -362,7 +451,7 @@ void BoardGUI_GtkCairo::visualizeMove(const Move &m, int gameID)
 
     // start animation
 
-    g_timeout_add(20 /* ms */, animation_timer, this);
+    scheduleFrame();
 }
 
 void BoardGUI_GtkCairo::checkHover()
@@ -382,6 +471,41 @@ void BoardGUI_GtkCairo::draw_piece(cairo_t *cr, Point2D pos_inUnits, Player play
 }
 
 void BoardGUI_GtkCairo::draw_piece_inPixels(cairo_t *cr, Point2D pos_inPixels, Player player, bool transparent)
+{
+    cairo_surface_t *&sprite = pieceSprite[player == PL_White ? 0 : 1][transparent ? 1 : 0];
+
+    if (sprite == NULL) {
+        // leave one pixel for the antialiased outline
+        pieceSpriteSize = 2 * (int)ceil(geom.getPieceRadiusInPixels() + 1);
+
+        sprite = cairo_surface_create_similar(cairo_get_target(cr), CAIRO_CONTENT_COLOR_ALPHA,
+                                              pieceSpriteSize, pieceSpriteSize);
+
+        cairo_t *sprite_cr = cairo_create(sprite);
+        cairo_translate(sprite_cr, pieceSpriteSize / 2, pieceSpriteSize / 2);
+        render_piece(sprite_cr, player, transparent);
+        cairo_destroy(sprite_cr);
+    }
+
+    cairo_set_source_surface(cr, sprite,
+                             pos_inPixels.x - pieceSpriteSize / 2,
+                             pos_inPixels.y - pieceSpriteSize / 2);
+    cairo_paint(cr);
+}
+
+void BoardGUI_GtkCairo::invalidatePieceSprites()
+{
+    for (int p = 0; p < 2; p++)
+        for (int t = 0; t < 2; t++) {
+            if (pieceSprite[p][t]) {
+                cairo_surface_destroy(pieceSprite[p][t]);
+                pieceSprite[p][t] = NULL;
+            }
+        }
+}
+
+// draw a piece centered at the origin
+void BoardGUI_GtkCairo::render_piece(cairo_t *cr, Player player, bool transparent)
 {
     float col_main = 0.0;
     float col_med = 0.5;
@@ -393,9 +517,6 @@ void BoardGUI_GtkCairo::draw_piece_inPixels(cairo_t *cr, Point2D pos_inPixels, P
         std::swap(col_main, col_high);
     }
 
-    cairo_save(cr);
-    cairo_translate(cr, pos_inPixels.x, pos_inPixels.y);
-
     const float alpha = (transparent ? 0.5 : 1.0);
 
     cairo_set_source_rgba(cr, col_main, col_main, col_main, alpha);
@@ -411,8 +532,6 @@ void BoardGUI_GtkCairo::draw_piece_inPixels(cairo_t *cr, Point2D pos_inPixels, P
     cairo_stroke(cr);
     cairo_arc(cr, 0, 0, 0.37 * radius, 0., 2 * M_PI);
     cairo_stroke(cr);
-
-    cairo_restore(cr);
 }
 
 Point2D BoardGUI_GtkCairo::Geometry::getStackPiecePos(Player p, int n) const
@@ -586,41 +705,27 @@ void BoardGUI_GtkCairo::draw_board_complete()
     draw_board(0, 0, width, height);
 }
 
-void BoardGUI_GtkCairo::draw_board(int x0, int y0, int w, int h)
+void BoardGUI_GtkCairo::invalidateBoardLayer()
 {
-    GameControl &control = MainApp::app().getControl();
-
-    const HoverState &hoverState = getHoverState();
-
-    cairo_t *cr = gdk_cairo_create(offscreenBuffer);
-
-    //std::cout << "redraw(" << x0 << "," << y0 << ", " << w << "," << h << ")\n";
-
-    // set clip-path to expose-rectangle
-
-    GdkRectangle rect;
-    rect.x = x0;
-    rect.y = y0;
-    rect.width = w;
-    rect.height = h;
+    if (boardLayer) {
+        cairo_surface_destroy(boardLayer);
+        boardLayer = NULL;
+    }
+}
 
-    gdk_cairo_rectangle(cr, &rect);
-    cairo_clip(cr);
+// the static part of the board, which does not change during the game
+void BoardGUI_GtkCairo::draw_boardLayer(cairo_t *cr, int w, int h)
+{
+    GameControl &control = MainApp::app().getControl();
+    boardspec_ptr board = control.getBoardSpec();
 
     // draw background
 
     const float bkggrey = 0.7;
 
-    {
-        gint width, height;
-        gdk_drawable_get_size(offscreenBuffer, &width, &height);
-        cairo_set_source_rgb(cr, bkggrey, bkggrey, bkggrey);
-        cairo_rectangle(cr, x0, y0, w, h);
-        cairo_fill(cr);
-    }
-
-    boardspec_ptr board = control.getBoardSpec();
-    const float pieceSize = geom.getPieceRadiusInPixels();
+    cairo_set_source_rgb(cr, bkggrey, bkggrey, bkggrey);
+    cairo_rectangle(cr, 0, 0, w, h);
+    cairo_fill(cr);
 
     // draw coordinate-grid
 
@@ -662,8 +767,64 @@ void BoardGUI_GtkCairo::draw_board(int x0, int y0, int w, int h)
         cairo_arc(cr, p.x, p.y, geom.scale_units2pixels * 1 / 64, 0., 2 * M_PI);
         cairo_fill(cr);
 
-        if (getGfxState() == GS_DraggingPiece && options.coloredCrossingWhileDragging) {
-            // colored crossings
+        cairo_set_source_rgb(cr, 1, 1, 1);
+        cairo_arc(cr, p.x, p.y, geom.scale_units2pixels * 5 / (7 * 64), 0., 2 * M_PI);
+        cairo_fill(cr);
+    }
+}
+
+void BoardGUI_GtkCairo::draw_board(int x0, int y0, int w, int h)
+{
+    GameControl &control = MainApp::app().getControl();
+
+    const HoverState &hoverState = getHoverState();
+
+    cairo_t *cr = gdk_cairo_create(offscreenBuffer);
+
+    //std::cout << "redraw(" << x0 << "," << y0 << ", " << w << "," << h << ")\n";
+
+    // set clip-path to expose-rectangle
+
+    GdkRectangle rect;
+    rect.x = x0;
+    rect.y = y0;
+    rect.width = w;
+    rect.height = h;
+
+    gdk_cairo_rectangle(cr, &rect);
+    cairo_clip(cr);
+
+    // copy the static board, render it first if required
+
+    gint width, height;
+    gdk_drawable_get_size(offscreenBuffer, &width, &height);
+
+    if (boardLayer && (boardLayerWidth != width || boardLayerHeight != height)) {
+        invalidateBoardLayer();
+    }
+
+    if (boardLayer == NULL) {
+        boardLayer = cairo_surface_create_similar(cairo_get_target(cr), CAIRO_CONTENT_COLOR, width, height);
+        boardLayerWidth = width;
+        boardLayerHeight = height;
+
+        cairo_t *layer_cr = cairo_create(boardLayer);
+        draw_boardLayer(layer_cr, width, height);
+        cairo_destroy(layer_cr);
+    }
+
+    cairo_set_source_surface(cr, boardLayer, 0, 0);
+    cairo_paint(cr);
+
+    boardspec_ptr board = control.getBoardSpec();
+    const float pieceSize = geom.getPieceRadiusInPixels();
+
+    // colored crossings
+
+    if (getGfxState() == GS_DraggingPiece && options.coloredCrossingWhileDragging) {
+        for (int i = 0; i < board->nPositions(); i++) {
+            Point2D p = board->getPositionLocation(i);
+            p = geom.board2Pixel(p);
 
             Move m = getPlayerMove();
             m.newPos = i;
@@ -672,12 +833,10 @@ void BoardGUI_GtkCairo::draw_board(int x0, int y0, int w, int h)
             } else {
                 cairo_set_source_rgb(cr, 1, 0, 0);
             }
-        } else {
-            cairo_set_source_rgb(cr, 1, 1, 1);
-        }
 
-        cairo_arc(cr, p.x, p.y, geom.scale_units2pixels * 5 / (7 * 64), 0., 2 * M_PI);
-        cairo_fill(cr);
+            cairo_arc(cr, p.x, p.y, geom.scale_units2pixels * 5 / (7 * 64), 0., 2 * M_PI);
+            cairo_fill(cr);
+        }
     }
 
     // draw pieces stacks
@@ -930,8 +1089,6 @@ void BoardGUI_GtkCairo::doPieceDrag(Point2D pixelPos, bool valid)
 
     drag_position = pixelPos;
 
-    boardGfxInvalid = true;
-
     Point2D newpos = pixelPos;
     newpos.x += drag_offset_x;
     newpos.y += drag_offset_y;
@@ -1089,20 +1246,30 @@ gint realize_area(GtkWidget *widget, gpointer obj)
     return TRUE;
 }
 
-gint animation_timer(gpointer obj)
+gint render_frame(gpointer obj)
 {
     BoardGUI_GtkCairo *self = (BoardGUI_GtkCairo *)(obj);
-    return self->cb_animation_timer();
+    return self->cb_render_frame();
 }
 
 BoardGUI_GtkCairo::BoardGUI_GtkCairo()
     : drawingArea(NULL),
     offscreenBuffer(NULL),
-    boardGfxInvalid(true),
+    frameTimer(0),
+    boardLayer(NULL),
+    boardLayerWidth(0),
+    boardLayerHeight(0),
+    pieceSpriteSize(0),
     removeStackPiece(PL_None),
     drag_active(false),
     m_showHint(false)
 {
+    for (int p = 0; p < 2; p++)
+        for (int t = 0; t < 2; t++)
+            pieceSprite[p][t] = NULL;
+
+    dirtyRegion = gdk_region_new();
+
     drawingArea = gtk_drawing_area_new();
     gtk_drawing_area_size(GTK_DRAWING_AREA(drawingArea),
                           10 * 64, 7 * 64);
@@ -1126,6 +1293,15 @@ BoardGUI_GtkCairo::BoardGUI_GtkCairo()
 
 BoardGUI_GtkCairo::~BoardGUI_GtkCairo()
 {
+    invalidateBoardLayer();
+    invalidatePieceSprites();
+
+    if (frameTimer) {
+        g_source_remove(frameTimer);
+    }
+
+    gdk_region_destroy(dirtyRegion);
+
     if (offscreenBuffer) {
         gdk_pixmap_unref(offscreenBuffer);
         offscreenBuffer = NULL;
@@ -119,7 +119,29 @@ public:
 private:
     GtkWidget *drawingArea;
     GdkPixmap *offscreenBuffer;
-    bool boardGfxInvalid;
+
+    /* Render scheduling. Invalidated areas are collected in 'dirtyRegion' and
+       repainted together in the next frame. Frames run at most MAX_FRAME_RATE
+       times per second, and only while there is something to draw or animate. */
+    enum { MAX_FRAME_RATE = 50 };
+
+    GdkRegion *dirtyRegion;
+    guint frameTimer;
+
+    void invalidateRect(const GdkRectangle *); // NULL: whole window
+    void scheduleFrame();
+    void paintDirtyRegion();
+
+    /* The static part of the board (background, coordinates, lines, and crossings)
+       is rendered once into this surface and copied on each redraw. It is recreated
+       when the window size changes or the display is reset. */
+    cairo_surface_t *boardLayer;
+    int boardLayerWidth, boardLayerHeight;
+
+    /* Pre-rendered pieces at the current scale, indexed by [player][halfTransparent].
+       They are recreated when the geometry changes. */
+    cairo_surface_t *pieceSprite[2][2];
+    int pieceSpriteSize;
 
     struct OverlayPiece
     {
@@ -135,14 +157,19 @@ private:
 
     void draw_board_complete();
     void draw_board(int x0, int y0, int w, int h);
+    void draw_boardLayer(cairo_t *, int w, int h);
+    void invalidateBoardLayer();
     void expose_area_rect(int x0, int y0, int w, int h);
 
     void invalidatePiecePos(Point2D pos_inUnits, float extraRadius = 0);
+    void invalidateHint();
     virtual void invalidateHoverAtPos(Position);
     virtual void changeGfxState(GfxState);
 
     void draw_piece(cairo_t *cr, Point2D pos_inUnits, Player player, bool halfTransparent = false);
     void draw_piece_inPixels(cairo_t *cr, Point2D pos_inPixels, Player player, bool halfTransparent = false);
+    void render_piece(cairo_t *cr, Player player, bool halfTransparent);
+    void invalidatePieceSprites();
 
     // geometric layout
 
@@ -214,7 +241,7 @@ private:
     void cb_expose_area(GtkWidget *widget, GdkEventExpose *event);
     void cb_configure_area(GtkWidget *widget, GdkEventConfigure *event);
     void cb_realize_area(GtkWidget *widget);
-    gint cb_animation_timer();
+    gint cb_render_frame();
 
     // kicker functions
 
@@ -225,7 +252,7 @@ private:
     friend gint expose_area(GtkWidget *widget, GdkEventExpose *event, gpointer obj);
     friend gint configure_area(GtkWidget *widget, GdkEventConfigure *event, gpointer obj);
     friend gint realize_area(GtkWidget *widget, gpointer obj);
-    friend gint animation_timer(gpointer obj);
+    friend gint render_frame(gpointer obj);
 
     // animation classes are friends
 
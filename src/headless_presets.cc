@@ -0,0 +1,39 @@
+/***************************************************************************
+  This file is part of Morris.
+  Copyright (C) 2009 Dirk Farin <dirk.farin@gmail.com>
+
+  Morris is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+***************************************************************************/
+
+
+#include "headless_presets.hh"
+
+const PresetName presetNames[] =
+{
+    {"standard", RuleSpec::Preset_Standard},
+    {"lasker", RuleSpec::Preset_Lasker},
+    {"moebius", RuleSpec::Preset_Moebius},
+    {"morabaraba", RuleSpec::Preset_Morabaraba},
+    {"windmill", RuleSpec::Preset_Windmill},
+    {"sunmill", RuleSpec::Preset_Sunmill},
+    {"6mm", RuleSpec::Preset_6MM},
+    {"7mm", RuleSpec::Preset_7MM},
+    {"tapatan", RuleSpec::Preset_Tapatan},
+    {"achi", RuleSpec::Preset_Achi},
+    {"smalltri", RuleSpec::Preset_SmallTri},
+    {"nineholes", RuleSpec::Preset_NineHoles},
+    {"polygon3", RuleSpec::Preset_Polygon3},
+    {"polygon5", RuleSpec::Preset_Polygon5},
+    {"polygon6", RuleSpec::Preset_Polygon6},
+    {NULL} };
@@ -0,0 +1,36 @@
+/***************************************************************************
+  This file is part of Morris.
+  Copyright (C) 2009 Dirk Farin <dirk.farin@gmail.com>
+
+  Morris is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+***************************************************************************/
+
+
+#ifndef HEADLESS_PRESETS_HH
+#define HEADLESS_PRESETS_HH
+
+#include "rules.hh"
+
+/* Short names of the rule presets for the command-line tools.
+   The list is terminated by an entry with a NULL name.
+ */
+struct PresetName
+{
+    const char *name;
+    RuleSpec::RulePreset preset;
+};
+
+extern const PresetName presetNames[];
+
+#endif
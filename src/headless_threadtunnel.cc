@@ -0,0 +1,127 @@
+/***************************************************************************
+  This file is part of Morris.
+  Copyright (C) 2009 Dirk Farin <dirk.farin@gmail.com>
+
+  Morris is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+***************************************************************************/
+
+
+#include "headless_threadtunnel.hh"
+
+#include <vector>
+#include <fstream>
+#include <stdlib.h>
+
+ThreadTunnel_Headless::ThreadTunnel_Headless()
+{
+    g_mutex_init(&m_mutex);
+    g_cond_init(&m_cond);
+
+    m_moveAvailable = false;
+    m_moveID = 0;
+}
+
+ThreadTunnel_Headless::~ThreadTunnel_Headless()
+{
+    g_cond_clear(&m_cond);
+    g_mutex_clear(&m_mutex);
+}
+
+void ThreadTunnel_Headless::doMove(Move m, int moveID)
+{
+    g_mutex_lock(&m_mutex);
+
+    // ignore moves of searches that were already abandoned
+    if (moveID == m_moveID) {
+        m_move = m;
+        m_moveAvailable = true;
+        g_cond_signal(&m_cond);
+    }
+
+    g_mutex_unlock(&m_mutex);
+}
+
+Move ThreadTunnel_Headless::computeMove(PlayerIF &player, const Board &board)
+{
+    g_mutex_lock(&m_mutex);
+    m_moveAvailable = false;
+    m_moveID++;
+    const int moveID = m_moveID;
+    g_mutex_unlock(&m_mutex);
+
+    player.startMove(board, moveID);
+
+    g_mutex_lock(&m_mutex);
+    while (!m_moveAvailable) {
+        g_cond_wait(&m_cond, &m_mutex);
+    }
+    Move m = m_move;
+    g_mutex_unlock(&m_mutex);
+
+    // the move was sent, so this only joins the finished thread
+    player.cancelMove();
+    runPendingIdleFuncs();
+
+    return m;
+}
+
+static GMutex searchLogMutex;
+static std::ofstream searchLog;
+static bool searchLogOpened = false;
+
+void ThreadTunnel_Headless::reportSearchInfo(const SearchInfo &info)
+{
+    g_mutex_lock(&searchLogMutex);
+
+    if (!searchLogOpened) {
+        searchLogOpened = true;
+
+        const char *filename = getenv(SEARCH_LOG_VARIABLE);
+        if (filename) {
+            searchLog.open(filename, std::ios::app);
+        }
+    }
+
+    if (searchLog.is_open()) {
+        searchLog << info << std::endl;
+    }
+
+    g_mutex_unlock(&searchLogMutex);
+}
+
+// ---------------------------------------------------------------------------
+
+static GMutex idleFuncMutex;
+static std::vector<IdleFunc *> idleFuncs;
+
+void IdleFunc::install(IdleFunc *func)
+{
+    g_mutex_lock(&idleFuncMutex);
+    idleFuncs.push_back(func);
+    g_mutex_unlock(&idleFuncMutex);
+}
+
+void runPendingIdleFuncs()
+{
+    std::vector<IdleFunc *> funcs;
+
+    g_mutex_lock(&idleFuncMutex);
+    funcs.swap(idleFuncs);
+    g_mutex_unlock(&idleFuncMutex);
+
+    for (size_t i = 0; i < funcs.size(); i++) {
+        (*funcs[i])();
+        delete funcs[i];
+    }
+}
@@ -0,0 +1,61 @@
+/***************************************************************************
+  This file is part of Morris.
+  Copyright (C) 2009 Dirk Farin <dirk.farin@gmail.com>
+
+  Morris is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+***************************************************************************/
+
+
+#ifndef HEADLESS_THREADTUNNEL_HH
+#define HEADLESS_THREADTUNNEL_HH
+
+#include "threadtunnel.hh"
+#include "player.hh"
+
+#include <glib.h>
+
+/* A thread-tunnel for running players without a GUI main-loop, as used by
+   the command-line tools. Moves computed in the player threads are handed
+   back to the calling thread, which blocks until the move is available.
+   Idle-functions installed by the players are queued and executed by the
+   calling thread after each move.
+ */
+class ThreadTunnel_Headless : public ThreadTunnel
+{
+public:
+    ThreadTunnel_Headless();
+    ~ThreadTunnel_Headless();
+
+    void doMove(Move m, int moveID);
+
+    // Written to the search log (see searchinfo.hh). Shared by all thread-tunnels.
+    void reportSearchInfo(const SearchInfo &);
+
+    /* Let the player compute its move for the given board and wait for it.
+       The player thread is joined before returning. */
+    Move computeMove(PlayerIF &, const Board &);
+
+private:
+    GMutex m_mutex;
+    GCond m_cond;
+
+    bool m_moveAvailable;
+    Move m_move;
+    int m_moveID;
+};
+
+// Execute all idle-functions that were installed since the last call.
+void runPendingIdleFuncs();
+
+#endif
@@ -0,0 +1,352 @@
+/***************************************************************************
+  This file is part of Morris.
+  Copyright (C) 2009 Dirk Farin <dirk.farin@gmail.com>
+
+  Morris is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+***************************************************************************/
+
+
+#include "learn.hh"
+
+#include <iostream>
+#include <string.h>
+#include <glib/gstdio.h>
+
+static const BoardID EMPTY_ID = ~BoardID(0);
+
+static const char MAGIC[8] = { 'M', 'O', 'R', 'R', 'I', 'S', 'E', 'X' };
+static const int VERSION = 2; // 2: symmetries map mills onto mills
+
+// Experience files are exchanged between machines, hence all numbers are stored little-endian.
+static const int CHUNK_HEADER_SIZE = 8 + 4 + 8 + 4;
+static const int RECORD_SIZE = 8 + 4;
+
+static void putNumber(unsigned char *&p, unsigned long long v, int nBytes)
+{
+    for (int i = 0; i < nBytes; i++)     {
+        *p++ = (v >> (8 * i)) & 0xFF;
+    }
+}
+
+static unsigned long long getNumber(const unsigned char *&p, int nBytes)
+{
+    unsigned long long v = 0;
+    for (int i = 0; i < nBytes; i++)     {
+        v |= (unsigned long long)(*p++) << (8 * i);
+    }
+    return v;
+}
+
+// Board IDs are highly structured, so mix all bits into the table index.
+static inline int hashIndex(BoardID b, int nBits)
+{
+    return int((b * 0x9E3779B97F4A7C15ULL) >> (64 - nBits));
+}
+
+Experience::Experience(int bits)
+    : rulesKey(0),
+    fh(NULL)
+{
+    g_mutex_init(&mutex);
+
+    nBits = bits;
+    nEntries = 0;
+    memory.resize(1 << nBits);
+    reset();
+}
+
+Experience::~Experience()
+{
+    detachFile();
+    g_mutex_clear(&mutex);
+}
+
+void Experience::reset()
+{
+    g_mutex_lock(&mutex);
+
+    for (int i = 0; i < memory.size(); i++)     {
+        memory[i].id = EMPTY_ID;
+        memory[i].offset = 0.0;
+    }
+
+    nEntries = 0;
+
+    g_mutex_unlock(&mutex);
+}
+
+int Experience::findSlot(BoardID b) const
+{
+    const int mask = (1 << nBits) - 1;
+
+    int idx = hashIndex(b, nBits);
+    while (memory[idx].id != b && memory[idx].id != EMPTY_ID)     {
+        idx = (idx + 1) & mask;
+    }
+
+    return idx;
+}
+
+void Experience::resize(int newBits)
+{
+    std::vector<MemEntry> old;
+    old.swap(memory);
+
+    nBits = newBits;
+    MemEntry empty;
+    empty.id = EMPTY_ID;
+    empty.offset = 0.0;
+    memory.resize(1 << nBits, empty);
+
+    for (int i = 0; i < old.size(); i++)     {
+        if (old[i].id != EMPTY_ID)         {
+            memory[findSlot(old[i].id)] = old[i];
+        }
+    }
+}
+
+void Experience::add(BoardID b, float offset)
+{
+    int idx = findSlot(b);
+    if (memory[idx].id == EMPTY_ID)     {
+        if ((nEntries + 1) * 100 > getCapacity() * MAX_FILL_PERCENT)         {
+            resize(nBits + 1);
+            idx = findSlot(b);
+        }
+
+        memory[idx].id = b;
+        memory[idx].offset = 0.0;
+        nEntries++;
+    }
+
+    memory[idx].offset += offset;
+}
+
+void Experience::addBoard(BoardID b, Player winner)
+{
+    g_mutex_lock(&mutex);
+    add(b, winner == PL_White ? 1.0 : -1.0);
+    g_mutex_unlock(&mutex);
+}
+
+void Experience::addGame(const std::vector<BoardID> &boards, Player winner)
+{
+    const float offset = (winner == PL_White ? 1.0 : -1.0);
+
+    g_mutex_lock(&mutex);
+
+    std::vector<MemEntry> records(boards.size());
+    for (int i = 0; i < boards.size(); i++)     {
+        add(boards[i], offset);
+
+        records[i].id = boards[i];
+        records[i].offset = offset;
+    }
+
+    if (fh != NULL && !boards.empty())     {
+        if (!writeChunk(fh, records) || fflush(fh) != 0)         {
+            std::cerr << "cannot write experience file " << filename << "\n";
+        }
+    }
+
+    g_mutex_unlock(&mutex);
+}
+
+float Experience::getOffset(BoardID b, Player self) const
+{
+    g_mutex_lock(&mutex);
+
+    int idx = findSlot(b);
+    float offset = memory[idx].offset; // zero for empty slots
+
+    g_mutex_unlock(&mutex);
+
+    return offset * (self == PL_White ? 1 : -1);
+}
+
+bool Experience::writeChunk(FILE *f, const std::vector<MemEntry> &records) const
+{
+    // write the chunk with a single fwrite() such that it is appended atomically
+
+    std::vector<unsigned char> buf(CHUNK_HEADER_SIZE + records.size() * RECORD_SIZE);
+    unsigned char *p = &buf[0];
+
+    memcpy(p, MAGIC, sizeof(MAGIC));
+    p += sizeof(MAGIC);
+    putNumber(p, VERSION, 4);
+    putNumber(p, rulesKey, 8);
+    putNumber(p, records.size(), 4);
+
+    for (int i = 0; i < records.size(); i++)     {
+        putNumber(p, records[i].id, 8);
+        putNumber(p, (unsigned int)(int)records[i].offset, 4);
+    }
+
+    return fwrite(&buf[0], buf.size(), 1, f) == 1;
+}
+
+int Experience::read(FILE *f)
+{
+    int nRecords = 0;
+
+    std::vector<unsigned char> buf;
+    unsigned char header[CHUNK_HEADER_SIZE];
+
+    // the size of the file, to check the record counts of the chunks
+
+    const long start = ftell(f);
+    if (start < 0 || fseek(f, 0, SEEK_END) != 0)     {
+        return 0;
+    }
+
+    const long end = ftell(f);
+    if (end < 0 || fseek(f, start, SEEK_SET) != 0)     {
+        return 0;
+    }
+
+    while (fread(header, CHUNK_HEADER_SIZE, 1, f) == 1)     {
+        const unsigned char *p = header + sizeof(MAGIC);
+        int version = getNumber(p, 4);
+        Key key = getNumber(p, 8);
+        int n = getNumber(p, 4);
+
+        // the files are exchanged between machines, do not trust the record count
+        const long remaining = end - ftell(f);
+
+        if (memcmp(header, MAGIC, sizeof(MAGIC)) != 0 || version != VERSION ||
+            n < 0 || n > remaining / RECORD_SIZE)         {
+            std::cerr << "invalid chunk in experience file\n";
+            break;
+        }
+
+        const size_t nBytes = size_t(n) * RECORD_SIZE;
+        buf.resize(nBytes + 1);
+        if (n > 0 && fread(&buf[0], nBytes, 1, f) != 1)         {
+            break; // truncated chunk
+        }
+
+        if (key != rulesKey)         {
+            continue;
+        }
+
+        p = &buf[0];
+        for (int i = 0; i < n; i++)         {
+            BoardID id = getNumber(p, 8);
+            int offset = (int)(unsigned int)getNumber(p, 4);
+            add(id, offset);
+        }
+
+        nRecords += n;
+    }
+
+    return nRecords;
+}
+
+int Experience::merge(const std::string &name)
+{
+    FILE *f = fopen(name.c_str(), "rb");
+    if (f == NULL)     {
+        return 0;
+    }
+
+    g_mutex_lock(&mutex);
+    int nRecords = read(f);
+    g_mutex_unlock(&mutex);
+
+    fclose(f);
+
+    return nRecords;
+}
+
+void Experience::attachFile(const std::string &name, Key key)
+{
+    detachFile();
+    reset();
+
+    g_mutex_lock(&mutex);
+
+    filename = name;
+    rulesKey = key;
+
+    int nRecords = 0;
+    FILE *f = fopen(filename.c_str(), "rb");
+    if (f != NULL)     {
+        nRecords = read(f);
+        fclose(f);
+    }
+
+    // Each game appends a chunk. When most of the records are repeated positions,
+    // rewrite the file with the accumulated offsets.
+
+    if (nRecords > 2 * nEntries + 1000)     {
+        compact();
+    }
+
+    fh = fopen(filename.c_str(), "ab");
+    if (fh == NULL)     {
+        std::cerr << "cannot open experience file " << filename << "\n";
+    }
+
+    g_mutex_unlock(&mutex);
+}
+
+void Experience::detachFile()
+{
+    g_mutex_lock(&mutex);
+
+    if (fh != NULL)     {
+        fclose(fh);
+        fh = NULL;
+    }
+
+    g_mutex_unlock(&mutex);
+}
+
+void Experience::compact()
+{
+    // Chunks for other rules are dropped. They should not be in this file anyway.
+
+    std::vector<MemEntry> records;
+    for (int i = 0; i < memory.size(); i++)     {
+        if (memory[i].id != EMPTY_ID)         {
+            records.push_back(memory[i]);
+        }
+    }
+
+    std::string tmpname = filename + ".tmp";
+    FILE *f = fopen(tmpname.c_str(), "wb");
+    if (f == NULL)     {
+        return;
+    }
+
+    bool ok = writeChunk(f, records);
+    ok = (fclose(f) == 0) && ok;
+
+    if (!ok || g_rename(tmpname.c_str(), filename.c_str()) != 0)     {
+        g_remove(tmpname.c_str());
+    }
+}
+
+void Experience::getEntries(std::vector<std::pair<BoardID, float> > &entries) const
+{
+    g_mutex_lock(&mutex);
+
+    for (int i = 0; i < memory.size(); i++)     {
+        if (memory[i].id != EMPTY_ID)         {
+            entries.push_back(std::make_pair(memory[i].id, memory[i].offset));
+        }
+    }
+
+    g_mutex_unlock(&mutex);
+}
@@ -20,62 +20,92 @@
 #define LEARN_HH
 
 #include "board.hh"
+#include "rules.hh"
+#include "constants.hh"
+#include <vector>
+#include <string>
+#include <stdio.h>
+#include <glib.h>
 #include <boost/shared_ptr.hpp>
 
+/* Experience collects the outcome of finished games for each (symmetric) board ID.
+   The entries are kept in an open-addressing hash table with linear probing. The
+   table is enlarged when it gets too full, such that lookups stay O(1) independent
+   of the number of learned positions.
+
+   The experience can be attached to a file, from which it is loaded and to which
+   each learned game is appended. The file is a sequence of chunks, each consisting
+   of a header with the rules key and a list of (board ID, offset) records. Hence,
+   experience files of several machines can simply be merged by concatenating them.
+   Chunks for other rules are ignored.
+ */
 class Experience
 {
 public:
-    enum
-    {
-        SIGNIFICANT_BITS = 8
-    };
+    Experience(int nBits = EXPERIENCE_SIZE);
+    ~Experience();
 
-    void reset()
-    {
-        for (int i = 0; i < (1 << SIGNIFICANT_BITS); i++)
-            memory[i].clear();
-    }
+    void reset();
 
-    void addBoard(BoardID b, Player winner)
-    {
-        int list = b & ((1 << SIGNIFICANT_BITS) - 1);
-        float offset = (winner == PL_White ? 1.0 : -1.0);
+    void addBoard(BoardID b, Player winner);
+    void addGame(const std::vector<BoardID> &boards, Player winner);
+    float getOffset(BoardID b, Player self) const;
 
-        for (int i = 0; i < memory[list].size(); i++)         {
-            if (memory[list][i].id == b)             {
-                memory[list][i].offset += offset;
-                return;
-            }
-        }
+    /* Reset the experience and load it from the file. Subsequent games are appended to it. */
+    void attachFile(const std::string &filename, Key rulesKey);
+    void detachFile();
 
-        MemEntry mem;
-        mem.id = b;
-        mem.offset = offset;
-        memory[list].push_back(mem);
-        nEntries++;
+    /* Add the experience stored in the file for the current rules. Returns the number
+       of records read. */
+    int merge(const std::string &filename);
+
+    // Use the experience for these rules when merging files (set by attachFile()).
+    void setRulesKey(Key key)
+    {
+        rulesKey = key;
     }
 
-    float getOffset(BoardID b, Player self) const
+    // All learned positions with their accumulated offsets (positive if white won more often).
+    void getEntries(std::vector<std::pair<BoardID, float> > &) const;
+
+    int getNEntries() const
     {
-        int list = b & ((1 << SIGNIFICANT_BITS) - 1);
-        for (int i = 0; i < memory[list].size(); i++)         {
-            if (memory[list][i].id == b)             {
-                return memory[list][i].offset * (self == PL_White ? 1 : -1);
-            }
-        }
+        return nEntries;
+    }
 
-        return 0.0;
+    int getCapacity() const
+    {
+        return 1 << nBits;
     }
 
 private:
     struct MemEntry
     {
-        Key id;
+        BoardID id;
         float offset;
     };
 
-    std::vector<MemEntry> memory[1 << SIGNIFICANT_BITS];
+    enum
+    {
+        MAX_FILL_PERCENT = 75 // enlarge the table when more entries are used
+    };
+
+    int findSlot(BoardID b) const;
+    void resize(int newBits);
+    void add(BoardID b, float offset);
+    int read(FILE *fh);
+    bool writeChunk(FILE *fh, const std::vector<MemEntry> &records) const;
+    void compact();
+
+    std::vector<MemEntry> memory;
+    int nBits;
     int nEntries;
+
+    std::string filename;
+    Key rulesKey;
+    FILE *fh; // file to which learned games are appended
+
+    mutable GMutex mutex;
 };
 
 typedef boost::shared_ptr<Experience> experience_ptr;
@@ -20,6 +20,8 @@
 #include "algo_alphabeta.hh"
 #include "algo_random.hh"
 #include <assert.h>
+#include <string.h>
+#include <stdlib.h>
 #include <boost/bind.hpp>
 #include "util.hh"
 
@@ -37,6 +39,8 @@ MainApp::Options::Options()
 
 static boost::shared_ptr<MainApp> mainapp_singleton;
 
+static const int HINT_MULTIPV = 3; // number of alternative moves shown for a hint
+
 void MainApp::createMainAppSingleton()
 {
     // init tables
@@ -53,10 +57,12 @@ MainApp &MainApp::app()
 }
 
 MainApp::MainApp()
-    : threadTunnel(NULL),
+    : useNetwork(false),
+    threadTunnel(NULL),
     hintID(-100000) // set to a large negative number to avoid collision with gameID
 {
     experience = experience_ptr(new Experience);
+    loadExperience(*control.getRuleSpec());
 
     // initialize the two AI players
 
@@ -78,6 +84,7 @@ MainApp::MainApp()
         PlayerIF_AlgoAB *hintAlgo = new PlayerIF_AlgoAB;
         hint_computer = player_ptr(hintAlgo);
         hint_computer->setRuleSpec(control.getRuleSpec());
+        hintAlgo->setMultiPV(HINT_MULTIPV);
         hint_ttable = ttable_ptr(new TranspositionTable(TRANSPOSITION_TABLE_SIZE - 1));
         hintAlgo->registerTTable(hint_ttable);
         hintAlgo->registerExperience(experience);
@@ -101,6 +108,11 @@ void MainApp::init()
     control.getSignal_endMove().connect(boost::bind(&MainApp::endMove, this, _1));
     control.getSignal_gameOver().connect(boost::bind(&ApplicationGUI::showGameOverDialog, gui_application, _1));
 
+    const char *searchLogFile = getenv(SEARCH_LOG_VARIABLE);
+    if (searchLogFile)     {
+        searchLog.open(searchLogFile, std::ios::app);
+    }
+
     setStatusbarText();
 }
 
@@ -121,7 +133,8 @@ void MainApp::setRules(rulespec_ptr rules, bool significantChange)
     hint_computer->setRuleSpec(rules);
 
     control.registerRuleSpec(rules);
-    experience->reset();
+    loadExperience(*rules);
+    loadNetwork(*rules);
 
     if (significantChange)     {
         control.resetGame();
@@ -284,11 +297,143 @@ void MainApp::setShareTTables(bool share)
     }
 }
 
+void MainApp::setTTableSize(int megabytes)
+{
+    const int nBits = TranspositionTable::bitsForSize(megabytes);
+    if (ttable[0]->getNumEntries() == (1 << nBits))     {
+        return;
+    }
+
+    // a running search keeps its old table, see PlayerIF_AlgoAB::registerTTable()
+
+    for (int c = 0; c < 2; c++)     {
+        ttable[c] = ttable_ptr(new TranspositionTable(nBits));
+    }
+
+    setShareTTables(share_TT);
+
+    hint_ttable = ttable_ptr(new TranspositionTable(nBits - 1));
+    dynamic_cast<PlayerIF_AlgoAB *>(hint_computer.get())->registerTTable(hint_ttable);
+}
+
+void MainApp::setSymmetricTTables(bool flag)
+{
+    for (int c = 0; c < 2; c++)     {
+        dynamic_cast<PlayerIF_AlgoAB *>(player_computer[c].get())->setSymmetricTT(flag);
+    }
+
+    dynamic_cast<PlayerIF_AlgoAB *>(hint_computer.get())->setSymmetricTT(flag);
+}
+
+/* The experience for each set of rules is kept in the file <rules-key>.exp in the
+   user's data directory. Further files <rules-key>-*.exp (e.g., copied from other
+   machines) are merged in, but new games are only appended to the main file.
+ */
+void MainApp::loadExperience(const RuleSpec &rules)
+{
+    gchar *dir = g_build_filename(g_get_user_data_dir(), "morris", "experience", NULL);
+    g_mkdir_with_parents(dir, 0755);
+
+    gchar *prefix = g_strdup_printf("%016llx", rules.getRulesKey());
+    gchar *mainname = g_strdup_printf("%s.exp", prefix);
+    gchar *filename = g_build_filename(dir, mainname, NULL);
+
+    experience->attachFile(filename, rules.getRulesKey());
+
+    GDir *gdir = g_dir_open(dir, 0, NULL);
+    if (gdir != NULL)     {
+        const gchar *name;
+        while ((name = g_dir_read_name(gdir)) != NULL)         {
+            if (g_str_has_prefix(name, prefix) && g_str_has_suffix(name, ".exp") && strcmp(name, mainname) != 0)             {
+                gchar *importname = g_build_filename(dir, name, NULL);
+                experience->merge(importname);
+                g_free(importname);
+            }
+        }
+
+        g_dir_close(gdir);
+    }
+
+    g_free(filename);
+    g_free(mainname);
+    g_free(prefix);
+    g_free(dir);
+}
+
+void MainApp::setUseAnalysisCache(bool flag)
+{
+    if (flag == getUseAnalysisCache())     {
+        return;
+    }
+
+    if (flag)     {
+        gchar *dir = g_build_filename(g_get_user_cache_dir(), "morris", NULL);
+        g_mkdir_with_parents(dir, 0755);
+        gchar *filename = g_build_filename(dir, "analysis-cache", NULL);
+
+        analysisCache = analysiscache_ptr(new AnalysisCache(filename, ANALYSIS_CACHE_SIZE));
+
+        g_free(filename);
+        g_free(dir);
+    }     else     {
+        analysisCache.reset(); // saved once no search uses it anymore
+    }
+
+    for (int c = 0; c < 2; c++)     {
+        PlayerIF_AlgoAB *algo = dynamic_cast<PlayerIF_AlgoAB *>(player_computer[c].get());
+        algo->registerAnalysisCache(analysisCache);
+    }
+
+    dynamic_cast<PlayerIF_AlgoAB *>(hint_computer.get())->registerAnalysisCache(analysisCache);
+}
+
+void MainApp::setUseNeuralNetwork(bool flag)
+{
+    useNetwork = flag;
+    loadNetwork(*control.getRuleSpec());
+}
+
+// The network for the board is kept in <data-dir>/morris/nnue/, see NNUENetwork::fileName().
+void MainApp::loadNetwork(const RuleSpec &rules)
+{
+    network.reset();
+
+    if (useNetwork)     {
+        const int boardPreset = rules.boardSpec->getBoardPresetID();
+
+        gchar *filename = g_build_filename(g_get_user_data_dir(), "morris", "nnue",
+                                           NNUENetwork::fileName(boardPreset).c_str(), NULL);
+
+        nnue_ptr net = nnue_ptr(new NNUENetwork);
+        if (net->load(filename) && net->getBoardPreset() == boardPreset)         {
+            network = net;
+        }
+
+        g_free(filename);
+    }
+
+    for (int c = 0; c < 2; c++)     {
+        PlayerIF_AlgoAB *algo = dynamic_cast<PlayerIF_AlgoAB *>(player_computer[c].get());
+        algo->registerNetwork(network);
+    }
+
+    dynamic_cast<PlayerIF_AlgoAB *>(hint_computer.get())->registerNetwork(network);
+}
+
 void MainApp::setThinkingInfo(const std::string &thinking)
 {
     setStatusbarText_withThinking(thinking);
 }
 
+void MainApp::setSearchInfo(const SearchInfo &info)
+{
+    gui_application->setSearchInfo(info);
+
+    if (searchLog.is_open())     {
+        searchLog << info << std::endl;
+    }
+}
+
 void MainApp::setStatusbarText()
 {
     setStatusbarText_withThinking("");
@@ -336,6 +481,12 @@ void MainApp::setStatusbarText_withThinking(const std::string &thinkingSuffix)
             }             else if (move)             {
                 str += _("move a piece.");
             }
+
+            // thinking info of the hint computer
+            if (!thinkingSuffix.empty())             {
+                str += "   ";
+                str += thinkingSuffix;
+            }
         }         else         {
             str += _("computer is taking his turn...   ");
             str += thinkingSuffix;
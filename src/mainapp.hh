@@ -25,8 +25,12 @@
 #include "boardgui.hh"
 #include "appgui.hh"
 #include "learn.hh"
+#include "analysiscache.hh"
+#include "nnue.hh"
 #include "configmgr.hh"
 
+#include <fstream>
+
 /* The general state of the main application. This is not at the granularity of
    the state in GameControl, but rather extends it with an higher-level application state.
  */
@@ -70,6 +74,11 @@ public:
         return control;
     }
 
+    const Experience &getExperience() const
+    {
+        return *experience;
+    }
+
     /* Start the next move. Note that the next move is not started immediately, but
        simply marked down that it should be started. It will be started the next time
        the program gets idle. */
@@ -121,6 +130,28 @@ public:
     }
     void setShareTTables(bool share);
 
+    // Let all boards that are symmetric to each other share their table entries.
+    void setSymmetricTTables(bool flag);
+
+    // Memory for each transposition table, rounded down to a power of two.
+    void setTTableSize(int megabytes);
+
+    /* Keep the results of root searches in a file, such that they are available
+       in later sessions. */
+    void setUseAnalysisCache(bool flag);
+    bool getUseAnalysisCache() const
+    {
+        return analysisCache != NULL;
+    }
+
+    /* Evaluate with a trained neural network (see morris-nnue-train) if there is one
+       for the current board. The networks are read from the user's data directory. */
+    void setUseNeuralNetwork(bool flag);
+    bool getUseNeuralNetwork() const
+    {
+        return useNetwork;
+    }
+
     // --- hint AI ---
 
     void computeHint();
@@ -147,6 +178,9 @@ public:
 
     void setThinkingInfo(const std::string &);
 
+    // Show the statistics of a search iteration and write them to the search log (see searchinfo.hh).
+    void setSearchInfo(const SearchInfo &);
+
     // --- thread-tunnel ---
 
     // ThreadTunnel* getThreadTunnel() { return threadTunnel; }  // currently unused
@@ -172,6 +206,9 @@ private:
     bool share_TT;
     ttable_ptr ttable[2];
     experience_ptr experience;
+    analysiscache_ptr analysisCache;
+    bool useNetwork;
+    nnue_ptr network;
 
     // hint
 
@@ -188,8 +225,13 @@ private:
     appgui_ptr gui_application;
     ThreadTunnel *threadTunnel;
 
+    std::ofstream searchLog; // not open if not enabled
+
     void nextMove_butPauseIfAIPlayer();
 
+    void loadExperience(const RuleSpec &);
+    void loadNetwork(const RuleSpec &);
+
     // callbacks
     void setStatusbarText();                                       // check game state and set statusbar text accordingly
     void setStatusbarText_withThinking(const std::string &suffix); // check game state and set statusbar text accordingly
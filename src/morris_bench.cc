@@ -0,0 +1,147 @@
+/***************************************************************************
+  This file is part of Morris.
+  Copyright (C) 2009 Dirk Farin <dirk.farin@gmail.com>
+
+  Morris is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+***************************************************************************/
+
+
+/* A command-line benchmark for the alpha-beta search.
+   For each rule preset, a set of positions is generated by random play and
+   searched to a fixed depth with each of the search strategies. The total
+   search time and the search speed per strategy are reported together with
+   the faster one. Set MORRIS_SEARCH_LOG to get the statistics of each iteration.
+
+   Usage: morris-bench [depth] [positions-per-preset]
+ */
+
+#include "config.h"
+#include "algo_alphabeta.hh"
+#include "headless_threadtunnel.hh"
+#include "headless_presets.hh"
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <sys/time.h>
+#include <vector>
+#include <algorithm>
+
+static const struct
+{
+    const char *name;
+    PlayerIF_AlgoAB::SearchStrategy strategy;
+} strategies[] =
+{
+    {"make/unmake", PlayerIF_AlgoAB::Search_MakeUnmake},
+    {"copy/make", PlayerIF_AlgoAB::Search_CopyMake},
+    {NULL} };
+
+static const int SEED = 4711;
+
+static int timeDiff_ms(const struct timeval &t1,
+                       const struct timeval &t2)
+{
+    return (t2.tv_sec - t1.tv_sec) * 1000 + (t2.tv_usec - t1.tv_usec) / 1000;
+}
+
+/* Generate test positions by playing random moves from the initial position.
+   The positions are spread over the game, such that all game phases are covered. */
+static std::vector<Board> generatePositions(const RuleSpec &rules, int nPositions)
+{
+    std::vector<Board> positions;
+
+    for (int n = 0; n < nPositions; n++) {
+        Board b;
+        b.reset(rules.nPieces);
+
+        const int nPlies = n * 4;
+        for (int ply = 0; ply < nPlies; ply++) {
+            std::vector<Move> moves;
+            rules.generateMoves(moves, b);
+
+            Board next = b;
+            next.doMove(moves[rand() % moves.size()]);
+
+            if (rules.currentPlayerHasLost(next)) {
+                break;
+            }
+
+            b = next;
+        }
+
+        positions.push_back(b);
+    }
+
+    return positions;
+}
+
+int main(int argc, char **argv)
+{
+    int depth = 6;
+    int nPositions = 8;
+
+    if (argc > 1)
+        depth = atoi(argv[1]);
+    if (argc > 2)
+        nPositions = atoi(argv[2]);
+
+    Board::initHashValues();
+
+    ThreadTunnel_Headless tunnel;
+    ttable_ptr ttable = ttable_ptr(new TranspositionTable(TRANSPOSITION_TABLE_SIZE));
+
+    PlayerIF_AlgoAB algo;
+    algo.registerTTable(ttable);
+    algo.registerThreadTunnel(tunnel);
+    algo.setMaxDepth(depth);
+    algo.setDeterministic(true, SEED);
+
+    printf("%-12s %24s %24s  %s\n", "preset", strategies[0].name, strategies[1].name, "faster");
+
+    for (int p = 0; presetNames[p].name != NULL; p++) {
+        rulespec_ptr rules = RuleSpec::createPresetRule(presetNames[p].preset);
+        algo.setRuleSpec(rules);
+
+        srand(SEED);
+        std::vector<Board> positions = generatePositions(*rules, nPositions);
+
+        int timeMS[2];
+        long long nodes[2] = { 0, 0 };
+        std::vector<Move> bestMoves[2];
+
+        for (int s = 0; strategies[s].name != NULL; s++) {
+            algo.setSearchStrategy(strategies[s].strategy);
+
+            struct timeval startTime, endTime;
+            gettimeofday(&startTime, NULL);
+
+            for (size_t i = 0; i < positions.size(); i++) {
+                algo.setPlayer(positions[i].getCurrentPlayer());
+                bestMoves[s].push_back(tunnel.computeMove(algo, positions[i]));
+                nodes[s] += algo.getSearchInfo().nodes;
+            }
+
+            gettimeofday(&endTime, NULL);
+            timeMS[s] = timeDiff_ms(startTime, endTime);
+        }
+
+        printf("%-12s %8d ms %7lld kN/s %8d ms %7lld kN/s  %s%s\n", presetNames[p].name,
+               timeMS[0], nodes[0] / std::max(timeMS[0], 1),
+               timeMS[1], nodes[1] / std::max(timeMS[1], 1),
+               strategies[timeMS[1] < timeMS[0] ? 1 : 0].name,
+               bestMoves[0] == bestMoves[1] ? "" : "  (WARNING: strategies chose different moves)");
+    }
+
+    return 0;
+}
@@ -0,0 +1,535 @@
+/***************************************************************************
+  This file is part of Morris.
+  Copyright (C) 2009 Dirk Farin <dirk.farin@gmail.com>
+
+  Morris is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+***************************************************************************/
+
+
+/* A trainer for the neural network evaluation (see NNUENetwork). The positions
+   of self-played games (experience files, see Experience, or game records of
+   morris-selfplay) serve as training data, each labeled with the outcome of the games in which it occurred.
+   For each board, the positions of all rule presets played on it are combined and
+   a network is trained such that sigmoid(output) predicts the outcome for the
+   player to move. Training uses a floating-point copy of the network and mini-batch
+   gradient descent (Adam), with the gradient of each batch computed on all processor
+   cores. The weights are kept in the range of the fixed-point network and quantized
+   at the end.
+
+   The trained output is a logit, but the search combines the evaluation with
+   experience offsets and score margins in units of pieces. Hence, like the material
+   weight in morris-tune, the logit of one piece of material is fitted on the same
+   positions, and the output layer is divided by it before quantization. The error of the quantized network is computed with the fixed-point
+   accumulators as a check.
+
+   The networks are written to the output directory with the file names that
+   the program looks for (see NNUENetwork::fileName()).
+
+   Usage: morris-nnue-train [-j threads] [-e epochs] [-o directory] experience-or-record-file...
+ */
+
+#include "config.h"
+#include "eval.hh"
+#include "learn.hh"
+#include "gamerecord.hh"
+#include "nnue.hh"
+#include "headless_presets.hh"
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <vector>
+#include <string>
+#include <algorithm>
+
+static const int MIN_POSITIONS = 1000;
+static const int BATCH_SIZE = 1024;
+
+// limits of the float weights, such that the quantized values fit
+static const float MAX_W1 = 4.0;             // accumulators must not overflow 16 bits
+static const float MAX_W2 = 127.0 / NNUE_QB; // 8-bit range
+
+// search range of the logit of one piece
+static const double MIN_PIECE_LOGIT = 0.05;
+static const double MAX_PIECE_LOGIT = 20.0;
+
+/* The float network, stored as one array for the optimizer. */
+struct FloatNetwork
+{
+    float w1[NNUE_INPUTS][NNUE_HIDDEN];
+    float b1[NNUE_HIDDEN];
+    float w2[2 * NNUE_HIDDEN];
+    float b2;
+
+    enum
+    {
+        NPARAMS = NNUE_INPUTS * NNUE_HIDDEN + 3 * NNUE_HIDDEN + 1
+    };
+
+    float *params()
+    {
+        return &w1[0][0];
+    }
+    const float *params() const
+    {
+        return &w1[0][0];
+    }
+};
+
+struct Sample
+{
+    std::vector<short> feature[2]; // active features, [0]: player to move, [1]: opponent
+    float result;                  // 1 if the player to move won, 0 if lost
+    float count;                   // number of games with this result
+    float material;                // pieces of the player to move minus those of the opponent
+
+    BoardID id;
+    const RuleSpec *rules;
+};
+
+// --- parallel execution ---
+
+struct Job
+{
+    const Sample *const *samples;
+    int begin, end;
+
+    const FloatNetwork *net;
+    FloatNetwork gradient;
+    double error, count;
+};
+
+static double forward(const FloatNetwork &net, const Sample &s,
+                      float acc[2][NNUE_HIDDEN], float hidden[2][NNUE_HIDDEN])
+{
+    for (int p = 0; p < 2; p++) {
+        memcpy(acc[p], net.b1, sizeof(net.b1));
+        for (size_t f = 0; f < s.feature[p].size(); f++) {
+            const float *w = net.w1[s.feature[p][f]];
+            for (int i = 0; i < NNUE_HIDDEN; i++) {
+                acc[p][i] += w[i];
+            }
+        }
+
+        for (int i = 0; i < NNUE_HIDDEN; i++) {
+            hidden[p][i] = std::min(std::max(acc[p][i], 0.0f), 1.0f);
+        }
+    }
+
+    double out = net.b2;
+    for (int i = 0; i < NNUE_HIDDEN; i++) {
+        out += net.w2[i] * hidden[0][i] + net.w2[NNUE_HIDDEN + i] * hidden[1][i];
+    }
+
+    return out;
+}
+
+static gpointer computeGradient(gpointer data)
+{
+    Job &job = *(Job *)data;
+
+    memset(&job.gradient, 0, sizeof(job.gradient));
+    job.error = job.count = 0;
+
+    const FloatNetwork &net = *job.net;
+    FloatNetwork &grad = job.gradient;
+
+    for (int n = job.begin; n < job.end; n++) {
+        const Sample &s = *job.samples[n];
+
+        float acc[2][NNUE_HIDDEN], hidden[2][NNUE_HIDDEN];
+        const double p = 1.0 / (1.0 + exp(-forward(net, s, acc, hidden)));
+        const double diff = p - s.result;
+
+        job.error += s.count * diff * diff;
+        job.count += s.count;
+
+        const float g = s.count * 2 * diff * p * (1 - p);
+
+        grad.b2 += g;
+        for (int h = 0; h < 2; h++)
+            for (int i = 0; i < NNUE_HIDDEN; i++) {
+                grad.w2[h * NNUE_HIDDEN + i] += g * hidden[h][i];
+
+                if (acc[h][i] <= 0 || acc[h][i] >= 1) {
+                    continue;
+                }
+
+                const float dh = g * net.w2[h * NNUE_HIDDEN + i];
+                grad.b1[i] += dh;
+                for (size_t f = 0; f < s.feature[h].size(); f++) {
+                    grad.w1[s.feature[h][f]][i] += dh;
+                }
+            }
+    }
+
+    return NULL;
+}
+
+static void runJobs(std::vector<Job> &jobs)
+{
+    std::vector<GThread *> threads;
+    for (size_t t = 0; t < jobs.size(); t++) {
+        threads.push_back(g_thread_new("trainer", computeGradient, &jobs[t]));
+    }
+
+    for (size_t t = 0; t < threads.size(); t++) {
+        g_thread_join(threads[t]);
+    }
+}
+
+// Error and gradient (if not NULL) of the samples [begin;end[, both normalized by the game count.
+static double error(std::vector<Job> &jobs, const FloatNetwork &net,
+                    const std::vector<const Sample *> &samples, int begin, int end,
+                    FloatNetwork *gradient)
+{
+    for (size_t t = 0; t < jobs.size(); t++) {
+        jobs[t].samples = &samples[0];
+        jobs[t].begin = begin + (end - begin) * t / jobs.size();
+        jobs[t].end = begin + (end - begin) * (t + 1) / jobs.size();
+        jobs[t].net = &net;
+    }
+
+    runJobs(jobs);
+
+    double err = 0, count = 0;
+    for (size_t t = 0; t < jobs.size(); t++) {
+        err += jobs[t].error;
+        count += jobs[t].count;
+    }
+
+    if (gradient) {
+        memset(gradient, 0, sizeof(*gradient));
+        for (size_t t = 0; t < jobs.size(); t++)
+            for (int w = 0; w < FloatNetwork::NPARAMS; w++) {
+                gradient->params()[w] += jobs[t].gradient.params()[w] / count;
+            }
+    }
+
+    return err / count;
+}
+
+// --- training ---
+
+static void collectSamples(std::vector<Sample> &samples, const RuleSpec &rules,
+                           const std::vector<std::string> &files)
+{
+    Experience experience;
+    experience.setRulesKey(rules.getRulesKey());
+    for (size_t f = 0; f < files.size(); f++) {
+        if (!importGameRecords(files[f], rules, experience)) {
+            experience.merge(files[f]);
+        }
+    }
+
+    std::vector<std::pair<BoardID, float> > corpus;
+    experience.getEntries(corpus);
+
+    for (size_t i = 0; i < corpus.size(); i++) {
+        const float offset = corpus[i].second;
+        if (offset == 0) {
+            continue;
+        }
+
+        Board board;
+        rules.getBoardFromID(corpus[i].first, board);
+
+        const Player me = board.getCurrentPlayer();
+
+        Sample s;
+        for (int h = 0; h < 2; h++) {
+            const Player perspective = (h == 0 ? me : opponent(me));
+
+            for (int p = 0; p < rules.boardSpec->nPositions(); p++) {
+                if (board.getPosition(p) != PL_None) {
+                    s.feature[h].push_back(NNUENetwork::pieceFeature(perspective, board.getPosition(p), p));
+                }
+            }
+
+            s.feature[h].push_back(NNUENetwork::toSetFeature(perspective, PL_White, board.getNPiecesToSet(PL_White)));
+            s.feature[h].push_back(NNUENetwork::toSetFeature(perspective, PL_Black, board.getNPiecesToSet(PL_Black)));
+        }
+
+        const bool whiteWon = (offset > 0);
+        s.result = (whiteWon == (me == PL_White)) ? 1.0 : 0.0;
+        s.count = fabs(offset);
+        s.material = board.getNPiecesLeft(me) - board.getNPiecesLeft(opponent(me));
+        s.id = corpus[i].first;
+        s.rules = &rules;
+
+        samples.push_back(s);
+    }
+}
+
+static double materialError(const std::vector<Sample> &samples, double k)
+{
+    double err = 0, count = 0;
+
+    for (size_t n = 0; n < samples.size(); n++) {
+        const double diff = 1.0 / (1.0 + exp(-k * samples[n].material)) - samples[n].result;
+        err += samples[n].count * diff * diff;
+        count += samples[n].count;
+    }
+
+    return err / count;
+}
+
+/* The logit k of one piece of material, such that sigmoid(k * material) predicts
+   the outcomes with the least squared error (golden-section search). */
+static double fitPieceLogit(const std::vector<Sample> &samples)
+{
+    const double r = (sqrt(5.0) - 1) / 2;
+
+    double a = MIN_PIECE_LOGIT, b = MAX_PIECE_LOGIT;
+    double x1 = b - r * (b - a), x2 = a + r * (b - a);
+    double f1 = materialError(samples, x1), f2 = materialError(samples, x2);
+
+    while (b - a > 1e-4) {
+        if (f1 < f2) {
+            b = x2;
+            x2 = x1;
+            f2 = f1;
+            x1 = b - r * (b - a);
+            f1 = materialError(samples, x1);
+        } else {
+            a = x1;
+            x1 = x2;
+            f1 = f2;
+            x2 = a + r * (b - a);
+            f2 = materialError(samples, x2);
+        }
+    }
+
+    return (a + b) / 2;
+}
+
+static void initNetwork(FloatNetwork &net, RandomGenerator &random)
+{
+    for (int w = 0; w < FloatNetwork::NPARAMS; w++) {
+        net.params()[w] = (random.nextInt(20001) - 10000) * 1e-5; // [-0.1;0.1]
+    }
+
+    for (int i = 0; i < NNUE_HIDDEN; i++) {
+        net.b1[i] = 0.5;
+    }
+    net.b2 = 0;
+}
+
+static void clampNetwork(FloatNetwork &net)
+{
+    for (int f = 0; f < NNUE_INPUTS; f++)
+        for (int i = 0; i < NNUE_HIDDEN; i++) {
+            net.w1[f][i] = std::min(std::max(net.w1[f][i], -MAX_W1), MAX_W1);
+        }
+
+    for (int i = 0; i < NNUE_HIDDEN; i++) {
+        net.b1[i] = std::min(std::max(net.b1[i], -MAX_W1), MAX_W1);
+    }
+
+    for (int i = 0; i < 2 * NNUE_HIDDEN; i++) {
+        net.w2[i] = std::min(std::max(net.w2[i], -MAX_W2), MAX_W2);
+    }
+}
+
+static short quantize(float v, float scale)
+{
+    return short(std::min(std::max(floor(v * scale + 0.5), -32767.0), 32767.0));
+}
+
+// The output layer is divided by the logit of one piece, such that the output is in pieces.
+static void quantizeNetwork(NNUENetwork &qnet, const FloatNetwork &net, double pieceLogit)
+{
+    for (int f = 0; f < NNUE_INPUTS; f++)
+        for (int i = 0; i < NNUE_HIDDEN; i++) {
+            qnet.w1[f][i] = quantize(net.w1[f][i], NNUE_QA);
+        }
+
+    for (int i = 0; i < NNUE_HIDDEN; i++) {
+        qnet.b1[i] = quantize(net.b1[i], NNUE_QA);
+    }
+
+    for (int i = 0; i < 2 * NNUE_HIDDEN; i++) {
+        qnet.w2[i] = quantize(net.w2[i] / pieceLogit, NNUE_QB);
+    }
+
+    qnet.b2 = int32_t(floor(net.b2 / pieceLogit * NNUE_QA * NNUE_QB + 0.5));
+}
+
+static double quantizedError(const NNUENetwork &qnet, const std::vector<Sample> &samples, double pieceLogit)
+{
+    double err = 0, count = 0;
+
+    for (size_t n = 0; n < samples.size(); n++) {
+        const Sample &s = samples[n];
+
+        Board board;
+        s.rules->getBoardFromID(s.id, board);
+
+        NNUEAccumulator acc;
+        qnet.refresh(acc, board);
+
+        const double out = pieceLogit * qnet.evaluate(acc, board.getCurrentPlayer());
+        const double diff = 1.0 / (1.0 + exp(-out)) - s.result;
+
+        err += s.count * diff * diff;
+        count += s.count;
+    }
+
+    return err / count;
+}
+
+static void trainBoard(BoardSpec::BoardPreset boardPreset, const std::vector<std::string> &files,
+                       const std::string &outDir, int nThreads, int nEpochs)
+{
+    std::vector<rulespec_ptr> rules;
+    std::vector<Sample> samples;
+
+    for (int p = 0; presetNames[p].name != NULL; p++) {
+        rulespec_ptr r = RuleSpec::createPresetRule(presetNames[p].preset);
+        if (r->boardSpec->getBoardPresetID() != boardPreset) {
+            continue;
+        }
+
+        // the positions are stored by their board ID, which cannot be decoded on all boards
+
+        if (!r->hasUniqueBoardIDs()) {
+            fprintf(stderr, "%s: skipped, board IDs are not unique on this board\n", presetNames[p].name);
+            continue;
+        }
+
+        rules.push_back(r);
+        collectSamples(samples, *r, files);
+    }
+
+    if (samples.size() < MIN_POSITIONS) {
+        return;
+    }
+
+    std::vector<const Sample *> order;
+    for (size_t n = 0; n < samples.size(); n++) {
+        order.push_back(&samples[n]);
+    }
+
+    RandomGenerator random(boardPreset + 1);
+
+    FloatNetwork *net = new FloatNetwork;
+    FloatNetwork *gradient = new FloatNetwork;
+    FloatNetwork *m = new FloatNetwork;
+    FloatNetwork *v = new FloatNetwork;
+
+    initNetwork(*net, random);
+    memset(m, 0, sizeof(*m));
+    memset(v, 0, sizeof(*v));
+
+    std::vector<Job> jobs(nThreads);
+
+    const double initialError = error(jobs, *net, order, 0, order.size(), NULL);
+
+    // Adam
+
+    const double rate = 0.001, beta1 = 0.9, beta2 = 0.999, epsilon = 1e-8;
+    int step = 0;
+
+    for (int epoch = 0; epoch < nEpochs; epoch++) {
+        for (int i = order.size() - 1; i > 0; i--) {
+            std::swap(order[i], order[random.nextInt(i + 1)]);
+        }
+
+        for (size_t begin = 0; begin < order.size(); begin += BATCH_SIZE) {
+            const int end = std::min(begin + BATCH_SIZE, order.size());
+            error(jobs, *net, order, begin, end, gradient);
+
+            step++;
+            const double c1 = 1.0 / (1.0 - pow(beta1, step));
+            const double c2 = 1.0 / (1.0 - pow(beta2, step));
+
+            for (int w = 0; w < FloatNetwork::NPARAMS; w++) {
+                const float g = gradient->params()[w];
+                float &mw = m->params()[w];
+                float &vw = v->params()[w];
+
+                mw = beta1 * mw + (1 - beta1) * g;
+                vw = beta2 * vw + (1 - beta2) * g * g;
+                net->params()[w] -= rate * (mw * c1) / (sqrt(vw * c2) + epsilon);
+            }
+
+            clampNetwork(*net);
+        }
+    }
+
+    const double err = error(jobs, *net, order, 0, order.size(), NULL);
+
+    const double pieceLogit = fitPieceLogit(samples);
+
+    NNUENetwork *qnet = new NNUENetwork;
+    quantizeNetwork(*qnet, *net, pieceLogit);
+    qnet->setBoardPreset(boardPreset);
+
+    const double qerr = quantizedError(*qnet, samples, pieceLogit);
+
+    const std::string filename = outDir + "/" + NNUENetwork::fileName(boardPreset);
+    const bool saved = qnet->save(filename);
+
+    printf("%s: %d positions, error %.4f -> %.4f (quantized %.4f), %.3f logit/piece%s\n",
+           filename.c_str(), int(samples.size()), initialError, err, qerr, pieceLogit,
+           saved ? "" : " -- cannot write file");
+
+    delete net;
+    delete gradient;
+    delete m;
+    delete v;
+    delete qnet;
+}
+
+static void usage()
+{
+    fprintf(stderr, "usage: morris-nnue-train [-j threads] [-e epochs] [-o directory] experience-or-record-file...\n");
+    exit(5);
+}
+
+int main(int argc, char **argv)
+{
+    int nThreads = g_get_num_processors();
+    int nEpochs = 100;
+    std::string outDir = ".";
+
+    std::vector<std::string> files;
+
+    for (int i = 1; i < argc; i++) {
+        /**/ if (strcmp(argv[i], "-j") == 0 && i + 1 < argc) {
+            nThreads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-e") == 0 && i + 1 < argc) {
+            nEpochs = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-o") == 0 && i + 1 < argc) {
+            outDir = argv[++i];
+        } else if (argv[i][0] == '-') {
+            usage();
+        } else {
+            files.push_back(argv[i]);
+        }
+    }
+
+    if (files.empty() || nThreads < 1) {
+        usage();
+    }
+
+    Board::initHashValues();
+
+    for (int b = 0; b < BoardSpec::Board_Unknown; b++) {
+        trainBoard(BoardSpec::BoardPreset(b), files, outDir, nThreads, nEpochs);
+    }
+
+    return 0;
+}
@@ -0,0 +1,311 @@
+/***************************************************************************
+  This file is part of Morris.
+  Copyright (C) 2009 Dirk Farin <dirk.farin@gmail.com>
+
+  Morris is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+***************************************************************************/
+
+
+/* A headless self-play generator. The AI plays games against itself, one game per
+   processor core at a time, and all positions with the played moves, the search
+   scores, and the game results are appended to a game-record file (see GameRecordWriter).
+   The records can be used by morris-tune and morris-nnue-train in place of
+   experience files.
+
+   Each game starts with a number of random moves, such that the games differ.
+   The searches are deterministic (see PlayerIF_AlgoAB::setDeterministic()) with a
+   seed derived from the game number, hence a run can be reproduced with the same
+   parameters. The games are written in the order of their game numbers, independent
+   of the number of threads. Games that do not end within the ply limit are recorded as ties.
+
+   Usage: morris-selfplay [-j threads] [-g games] [-d depth] [-n nodes] [-r random-plies]
+                          [-s seed] [-p preset] [-t table-MB] output-file
+ */
+
+#include "config.h"
+#include "algo_alphabeta.hh"
+#include "gamerecord.hh"
+#include "headless_threadtunnel.hh"
+#include "headless_presets.hh"
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+#include <string>
+#include <map>
+
+static const int MAX_PLIES = 400;
+
+struct Options
+{
+    int nGames;
+    int depth;
+    long long nodes;
+    int randomPlies;
+    unsigned long long seed;
+};
+
+/* The state shared by all worker threads. */
+struct Generator
+{
+    Options options;
+    rulespec_ptr rules;
+
+    GMutex mutex; // protects the members below
+    int nextGame;
+    GameRecordWriter writer;
+    bool writeError;
+
+    // Finished games that wait for the games with lower numbers to be written.
+    std::map<int, std::vector<PositionRecord> > pendingGames;
+    int nextGameToWrite;
+
+    int nFinished, nPositions;
+    int nWins[3]; // [winner+1]
+};
+
+/* The players are kept until all workers are finished, because the join handler of
+   a search thread may be executed by any worker (see runPendingIdleFuncs()). */
+struct Worker
+{
+    Generator *gen;
+
+    ThreadTunnel_Headless tunnel;
+    ttable_ptr ttable;
+    PlayerIF_AlgoAB algo;
+};
+
+// --- playing one game ---
+
+static Player playGame(const Generator &gen, int game, PlayerIF_AlgoAB &algo, ThreadTunnel_Headless &tunnel,
+                       std::vector<PositionRecord> &records)
+{
+    const RuleSpec &rules = *gen.rules;
+
+    RandomGenerator random(gen.options.seed * 1000003 + game);
+    algo.setDeterministic(true, random.next());
+    algo.resetGame();
+
+    // The boards are chained for the detection of repetitions.
+    boost::shared_ptr<Board> board(new Board);
+    board->reset(rules.nPieces);
+
+    Player winner = PL_None;
+
+    for (int ply = 0; ply < MAX_PLIES; ply++) {
+        if (rules.isGameOver(*board, &winner)) {
+            break;
+        }
+
+        std::vector<Move> moves;
+        rules.generateMoves(moves, *board);
+
+        Move move;
+        if (ply < gen.options.randomPlies) {
+            move = moves[random.nextInt(moves.size())];
+        } else {
+            algo.setPlayer(board->getCurrentPlayer());
+            move = tunnel.computeMove(algo, *board);
+
+            PositionRecord r;
+            r.id = rules.getBoardID(*board);
+            r.score = (board->getCurrentPlayer() == PL_White ? algo.getScore() : -algo.getScore());
+            r.move = move;
+            records.push_back(r);
+        }
+
+        boost::shared_ptr<Board> next(new Board(*board));
+        next->doMove(move);
+        next->setPrevBoard(board);
+        board = next;
+    }
+
+    for (size_t i = 0; i < records.size(); i++) {
+        records[i].winner = winner;
+        records[i].gameStart = (i == 0);
+    }
+
+    return winner;
+}
+
+static gpointer runWorker(gpointer data)
+{
+    Worker &worker = *(Worker *)data;
+    Generator &gen = *worker.gen;
+
+    PlayerIF_AlgoAB &algo = worker.algo;
+    algo.registerTTable(worker.ttable);
+    algo.registerThreadTunnel(worker.tunnel);
+    algo.setRuleSpec(gen.rules);
+    algo.setMaxDepth(gen.options.depth);
+    algo.setMaxNodes(gen.options.nodes);
+
+    for (;;) {
+        g_mutex_lock(&gen.mutex);
+        const int game = gen.nextGame++;
+        g_mutex_unlock(&gen.mutex);
+
+        if (game >= gen.options.nGames) {
+            break;
+        }
+
+        std::vector<PositionRecord> records;
+        const Player winner = playGame(gen, game, algo, worker.tunnel, records);
+
+        g_mutex_lock(&gen.mutex);
+
+        gen.nFinished++;
+        gen.nPositions += records.size();
+        gen.nWins[winner + 1]++;
+
+        gen.pendingGames[game].swap(records);
+
+        std::map<int, std::vector<PositionRecord> >::iterator next;
+        while (!gen.writeError &&
+               (next = gen.pendingGames.find(gen.nextGameToWrite)) != gen.pendingGames.end()) {
+            if (!gen.writer.writeGame(next->second)) {
+                gen.writeError = true;
+                gen.nextGame = gen.options.nGames; // stop all workers
+            }
+
+            gen.pendingGames.erase(next);
+            gen.nextGameToWrite++;
+        }
+
+        fprintf(stderr, "\r%d/%d games, %d positions", gen.nFinished, gen.options.nGames, gen.nPositions);
+
+        g_mutex_unlock(&gen.mutex);
+    }
+
+    return NULL;
+}
+
+// --- main ---
+
+static void usage()
+{
+    fprintf(stderr, "usage: morris-selfplay [-j threads] [-g games] [-d depth] [-n nodes] [-r random-plies]\n"
+                    "                       [-s seed] [-p preset] [-t table-MB] output-file\n");
+    exit(5);
+}
+
+int main(int argc, char **argv)
+{
+    int nThreads = g_get_num_processors();
+    const char *presetName = "standard";
+    const char *filename = NULL;
+    int ttableBits = TRANSPOSITION_TABLE_SIZE;
+
+    Options options;
+    options.nGames = 100;
+    options.depth = 6;
+    options.nodes = 0;
+    options.randomPlies = 6;
+    options.seed = 1;
+
+    for (int i = 1; i < argc; i++) {
+        /**/ if (strcmp(argv[i], "-j") == 0 && i + 1 < argc) {
+            nThreads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-g") == 0 && i + 1 < argc) {
+            options.nGames = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-d") == 0 && i + 1 < argc) {
+            options.depth = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+            options.nodes = atoll(argv[++i]);
+        } else if (strcmp(argv[i], "-r") == 0 && i + 1 < argc) {
+            options.randomPlies = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-s") == 0 && i + 1 < argc) {
+            options.seed = strtoull(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "-p") == 0 && i + 1 < argc) {
+            presetName = argv[++i];
+        } else if (strcmp(argv[i], "-t") == 0 && i + 1 < argc) {
+            ttableBits = TranspositionTable::bitsForSize(atoi(argv[++i]));
+        } else if (argv[i][0] == '-' || filename != NULL) {
+            usage();
+        } else {
+            filename = argv[i];
+        }
+    }
+
+    if (filename == NULL || nThreads < 1 || options.depth < 1) {
+        usage();
+    }
+
+    int p = 0;
+    while (presetNames[p].name != NULL && strcmp(presetNames[p].name, presetName) != 0) {
+        p++;
+    }
+
+    if (presetNames[p].name == NULL) {
+        fprintf(stderr, "unknown preset '%s'\n", presetName);
+        return 5;
+    }
+
+    Board::initHashValues();
+
+    Generator gen;
+    gen.options = options;
+    gen.rules = RuleSpec::createPresetRule(presetNames[p].preset);
+
+    if (!gen.rules->hasUniqueBoardIDs()) {
+        fprintf(stderr, "cannot record games of preset '%s', its board IDs are not unique\n", presetName);
+        return 5;
+    }
+    g_mutex_init(&gen.mutex);
+    gen.nextGame = 0;
+    gen.nextGameToWrite = 0;
+    gen.writeError = false;
+    gen.nFinished = gen.nPositions = 0;
+    gen.nWins[0] = gen.nWins[1] = gen.nWins[2] = 0;
+
+    if (!gen.writer.open(filename, gen.rules->getRulesKey())) {
+        fprintf(stderr, "cannot write game records to %s\n", filename);
+        return 10;
+    }
+
+    std::vector<Worker *> workers;
+    std::vector<GThread *> threads;
+    for (int t = 0; t < nThreads; t++) {
+        workers.push_back(new Worker);
+        workers[t]->gen = &gen;
+        workers[t]->ttable = ttable_ptr(new TranspositionTable(ttableBits));
+
+        threads.push_back(g_thread_new("selfplay", runWorker, workers[t]));
+    }
+
+    for (size_t t = 0; t < threads.size(); t++) {
+        g_thread_join(threads[t]);
+    }
+
+    runPendingIdleFuncs();
+
+    for (size_t t = 0; t < workers.size(); t++) {
+        delete workers[t];
+    }
+
+    fprintf(stderr, "\n");
+    printf("%d games: white won %d, black won %d, ties %d\n", gen.nFinished,
+           gen.nWins[PL_White + 1], gen.nWins[PL_Black + 1], gen.nWins[PL_None + 1]);
+
+    gen.writer.close();
+    g_mutex_clear(&gen.mutex);
+
+    if (gen.writeError) {
+        fprintf(stderr, "error writing game records to %s\n", filename);
+        return 10;
+    }
+
+    return 0;
+}
@@ -0,0 +1,351 @@
+/***************************************************************************
+  This file is part of Morris.
+  Copyright (C) 2009 Dirk Farin <dirk.farin@gmail.com>
+
+  Morris is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+***************************************************************************/
+
+
+/* An offline tuner for the evaluation weights, following Texel's tuning method.
+   The positions learned in experience files (see Experience) or recorded by
+   morris-selfplay serve as corpus, each labeled with the outcome of the games in
+   which it occurred. For each rule
+   preset, the weights of all evaluation terms and game phases are fitted such that
+   sigmoid(eval) predicts the outcome for the player to move with the least squared
+   error. Since the evaluation is linear in its terms, the terms are computed only
+   once per position. Feature extraction and error computation are distributed over
+   all processor cores.
+
+   The resulting weights are scaled such that the material weight in the moving
+   phase is 1, and printed as entries for the parameter table in eval.cc.
+
+   Usage: morris-tune [-j threads] [-i iterations] experience-or-record-file...
+ */
+
+#include "config.h"
+#include "eval.hh"
+#include "learn.hh"
+#include "gamerecord.hh"
+#include "headless_presets.hh"
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <vector>
+#include <string>
+
+enum
+{
+    NTUNED = Phase_NPHASES * Term_NTERMS // index: phase*Term_NTERMS + term
+};
+
+static const int MIN_POSITIONS = 100;
+
+struct Sample
+{
+    GamePhase phase;
+    float feature[Term_NTERMS];
+    float result; // 1 if the player to move won, 0 if lost
+    float count;  // number of games with this result
+};
+
+// --- parallel execution ---
+
+struct Job
+{
+    int begin, end; // range of samples or corpus entries
+
+    // feature extraction
+    const std::vector<std::pair<BoardID, float> > *corpus;
+    const RuleSpec *rules;
+    const Evaluation *evaluation;
+    std::vector<Sample> samples;
+
+    // error computation
+    const std::vector<Sample> *allSamples;
+    const double *v;
+    double error;
+    double gradient[NTUNED];
+};
+
+static gpointer extractFeatures(gpointer data)
+{
+    Job &job = *(Job *)data;
+
+    for (int i = job.begin; i < job.end; i++) {
+        const BoardID id = (*job.corpus)[i].first;
+        const float offset = (*job.corpus)[i].second;
+
+        if (offset == 0) {
+            continue;
+        }
+
+        Board board;
+        job.rules->getBoardFromID(id, board);
+
+        Sample s;
+        if (!job.evaluation->features(board, s.feature)) {
+            continue;
+        }
+
+        s.phase = job.evaluation->getPhase(board);
+
+        const bool whiteWon = (offset > 0);
+        s.result = (whiteWon == (board.getCurrentPlayer() == PL_White)) ? 1.0 : 0.0;
+        s.count = fabs(offset);
+
+        job.samples.push_back(s);
+    }
+
+    return NULL;
+}
+
+static gpointer computeError(gpointer data)
+{
+    Job &job = *(Job *)data;
+
+    job.error = 0;
+    for (int w = 0; w < NTUNED; w++) {
+        job.gradient[w] = 0;
+    }
+
+    for (int i = job.begin; i < job.end; i++) {
+        const Sample &s = (*job.allSamples)[i];
+
+        const double *v = &job.v[s.phase * Term_NTERMS];
+
+        double e = 0;
+        for (int t = 0; t < Term_NTERMS; t++) {
+            e += v[t] * s.feature[t];
+        }
+
+        const double p = 1.0 / (1.0 + exp(-e));
+        const double diff = p - s.result;
+
+        job.error += s.count * diff * diff;
+
+        const double g = s.count * 2 * diff * p * (1 - p);
+        for (int t = 0; t < Term_NTERMS; t++) {
+            job.gradient[s.phase * Term_NTERMS + t] += g * s.feature[t];
+        }
+    }
+
+    return NULL;
+}
+
+static void runJobs(std::vector<Job> &jobs, GThreadFunc func)
+{
+    std::vector<GThread *> threads;
+    for (size_t t = 0; t < jobs.size(); t++) {
+        threads.push_back(g_thread_new("tuner", func, &jobs[t]));
+    }
+
+    for (size_t t = 0; t < threads.size(); t++) {
+        g_thread_join(threads[t]);
+    }
+}
+
+static void splitRange(std::vector<Job> &jobs, int n)
+{
+    for (size_t t = 0; t < jobs.size(); t++) {
+        jobs[t].begin = n * t / jobs.size();
+        jobs[t].end = n * (t + 1) / jobs.size();
+    }
+}
+
+// Mean squared prediction error and its gradient for the scaled weights 'v'.
+static double error(std::vector<Job> &jobs, const double *v, double *gradient, double totalCount)
+{
+    for (size_t t = 0; t < jobs.size(); t++) {
+        jobs[t].v = v;
+    }
+
+    runJobs(jobs, computeError);
+
+    double err = 0;
+    for (int w = 0; w < NTUNED; w++) {
+        gradient[w] = 0;
+    }
+
+    for (size_t t = 0; t < jobs.size(); t++) {
+        err += jobs[t].error;
+        for (int w = 0; w < NTUNED; w++) {
+            gradient[w] += jobs[t].gradient[w];
+        }
+    }
+
+    for (int w = 0; w < NTUNED; w++) {
+        gradient[w] /= totalCount;
+    }
+
+    return err / totalCount;
+}
+
+static void tunePreset(const PresetName &preset, const std::vector<std::string> &files,
+                       int nThreads, int nIterations)
+{
+    rulespec_ptr rules = RuleSpec::createPresetRule(preset.preset);
+
+    // the positions are stored by their board ID, which cannot be decoded on all boards
+
+    if (!rules->hasUniqueBoardIDs()) {
+        fprintf(stderr, "%s: skipped, board IDs are not unique on this board\n", preset.name);
+        return;
+    }
+
+    Experience experience;
+    experience.setRulesKey(rules->getRulesKey());
+    for (size_t f = 0; f < files.size(); f++) {
+        if (!importGameRecords(files[f], *rules, experience)) {
+            experience.merge(files[f]);
+        }
+    }
+
+    std::vector<std::pair<BoardID, float> > corpus;
+    experience.getEntries(corpus);
+
+    if (corpus.size() < MIN_POSITIONS) {
+        return;
+    }
+
+    // compute the features
+
+    Evaluation evaluation;
+    evaluation.setRules(rules);
+
+    std::vector<Job> jobs(nThreads);
+    splitRange(jobs, corpus.size());
+    for (int t = 0; t < nThreads; t++) {
+        jobs[t].corpus = &corpus;
+        jobs[t].rules = rules.get();
+        jobs[t].evaluation = &evaluation;
+    }
+
+    runJobs(jobs, extractFeatures);
+
+    std::vector<Sample> samples;
+    double totalCount = 0;
+    for (int t = 0; t < nThreads; t++) {
+        for (size_t i = 0; i < jobs[t].samples.size(); i++) {
+            samples.push_back(jobs[t].samples[i]);
+            totalCount += jobs[t].samples[i].count;
+        }
+
+        jobs[t].samples.clear();
+        jobs[t].allSamples = &samples;
+    }
+
+    splitRange(jobs, samples.size());
+
+    if (samples.size() < MIN_POSITIONS) {
+        return;
+    }
+
+    /* Start with the current weights and fit the scaled weights v = K*w by gradient
+       descent with an adaptive step size. The scaling factor K of the sigmoid is
+       not fixed, because only the weight ratios matter for the search. */
+
+    const EvalParams &params = EvalParams::forBoard(rules->boardSpec->getBoardPresetID());
+
+    double v[NTUNED], gradient[NTUNED];
+    for (int phase = 0; phase < Phase_NPHASES; phase++)
+        for (int t = 0; t < Term_NTERMS; t++) {
+            v[phase * Term_NTERMS + t] = params.weight[phase][t];
+        }
+
+    const double initialError = error(jobs, v, gradient, totalCount);
+    double err = initialError;
+    double step = 1.0;
+
+    for (int iter = 0; iter < nIterations && step > 1e-9; iter++) {
+        double newV[NTUNED], newGradient[NTUNED];
+        for (int w = 0; w < NTUNED; w++) {
+            newV[w] = v[w] - step * gradient[w];
+        }
+
+        double newErr = error(jobs, newV, newGradient, totalCount);
+        if (newErr < err) {
+            memcpy(v, newV, sizeof(v));
+            memcpy(gradient, newGradient, sizeof(gradient));
+            err = newErr;
+            step *= 1.2;
+        } else {
+            step *= 0.5;
+        }
+    }
+
+    // output the weights, scaled to material weight 1
+
+    const double materialWeight = v[Phase_Moving * Term_NTERMS + Term_Material];
+    const double scale = (materialWeight > 0 ? materialWeight : 1.0);
+
+    printf("    // %s: %d positions, error %.4f -> %.4f\n", preset.name, int(samples.size()),
+           initialError, err);
+    printf("    { BoardSpec::BoardPreset(%d), {{\n", rules->boardSpec->getBoardPresetID());
+
+    for (int phase = 0; phase < Phase_NPHASES; phase++) {
+        printf("        {");
+        for (int t = 0; t < Term_NTERMS; t++) {
+            printf(" %6.3f%s", v[phase * Term_NTERMS + t] / scale, t + 1 < Term_NTERMS ? "," : "");
+        }
+        printf(" }%s // %s\n", phase + 1 < Phase_NPHASES ? "," : " ", Evaluation::phaseName(GamePhase(phase)));
+    }
+
+    printf("    }}},\n");
+}
+
+static void usage()
+{
+    fprintf(stderr, "usage: morris-tune [-j threads] [-i iterations] experience-or-record-file...\n");
+    exit(5);
+}
+
+int main(int argc, char **argv)
+{
+    int nThreads = g_get_num_processors();
+    int nIterations = 1000;
+
+    std::vector<std::string> files;
+
+    for (int i = 1; i < argc; i++) {
+        /**/ if (strcmp(argv[i], "-j") == 0 && i + 1 < argc) {
+            nThreads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-i") == 0 && i + 1 < argc) {
+            nIterations = atoi(argv[++i]);
+        } else if (argv[i][0] == '-') {
+            usage();
+        } else {
+            files.push_back(argv[i]);
+        }
+    }
+
+    if (files.empty() || nThreads < 1) {
+        usage();
+    }
+
+    Board::initHashValues();
+
+    printf("    //");
+    for (int t = 0; t < Term_NTERMS; t++) {
+        printf(" %s", Evaluation::termName(EvalTerm(t)));
+    }
+    printf("\n");
+
+    for (int p = 0; presetNames[p].name != NULL; p++) {
+        tunePreset(presetNames[p], files, nThreads, nIterations);
+    }
+
+    return 0;
+}
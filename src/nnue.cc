@@ -0,0 +1,303 @@
+/***************************************************************************
+  This file is part of Morris.
+  Copyright (C) 2009 Dirk Farin <dirk.farin@gmail.com>
+
+  Morris is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+***************************************************************************/
+
+
+#include "nnue.hh"
+#include "board.hh"
+
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+static const char MAGIC[8] = { 'M', 'O', 'R', 'R', 'I', 'S', 'N', 'N' };
+static const int VERSION = 2; // 2: output in pieces instead of the outcome logit
+
+NNUENetwork::NNUENetwork()
+{
+    memset(w1, 0, sizeof(w1));
+    memset(b1, 0, sizeof(b1));
+    memset(w2, 0, sizeof(w2));
+    b2 = 0;
+
+    m_boardPreset = -1;
+}
+
+// --- accumulator ---
+
+void NNUENetwork::addFeature(NNUEAccumulator &acc, int perspectiveIdx, int feature) const
+{
+    int16_t *a = acc.v[perspectiveIdx];
+    const int16_t *w = w1[feature];
+
+#ifdef __SSE2__
+    for (int i = 0; i < NNUE_HIDDEN; i += 8) {
+        __m128i v = _mm_loadu_si128((const __m128i *)&a[i]);
+        v = _mm_add_epi16(v, _mm_loadu_si128((const __m128i *)&w[i]));
+        _mm_storeu_si128((__m128i *)&a[i], v);
+    }
+#else
+    for (int i = 0; i < NNUE_HIDDEN; i++)
+        a[i] += w[i];
+#endif
+}
+
+void NNUENetwork::subFeature(NNUEAccumulator &acc, int perspectiveIdx, int feature) const
+{
+    int16_t *a = acc.v[perspectiveIdx];
+    const int16_t *w = w1[feature];
+
+#ifdef __SSE2__
+    for (int i = 0; i < NNUE_HIDDEN; i += 8) {
+        __m128i v = _mm_loadu_si128((const __m128i *)&a[i]);
+        v = _mm_sub_epi16(v, _mm_loadu_si128((const __m128i *)&w[i]));
+        _mm_storeu_si128((__m128i *)&a[i], v);
+    }
+#else
+    for (int i = 0; i < NNUE_HIDDEN; i++)
+        a[i] -= w[i];
+#endif
+}
+
+void NNUENetwork::clear(NNUEAccumulator &acc) const
+{
+    for (int p = 0; p < 2; p++)
+        memcpy(acc.v[p], b1, sizeof(b1));
+}
+
+void NNUENetwork::addPiece(NNUEAccumulator &acc, Player piece, int pos) const
+{
+    addFeature(acc, player2Index(PL_White), pieceFeature(PL_White, piece, pos));
+    addFeature(acc, player2Index(PL_Black), pieceFeature(PL_Black, piece, pos));
+}
+
+void NNUENetwork::removePiece(NNUEAccumulator &acc, Player piece, int pos) const
+{
+    subFeature(acc, player2Index(PL_White), pieceFeature(PL_White, piece, pos));
+    subFeature(acc, player2Index(PL_Black), pieceFeature(PL_Black, piece, pos));
+}
+
+void NNUENetwork::addToSet(NNUEAccumulator &acc, Player player, int n) const
+{
+    addFeature(acc, player2Index(PL_White), toSetFeature(PL_White, player, n));
+    addFeature(acc, player2Index(PL_Black), toSetFeature(PL_Black, player, n));
+}
+
+void NNUENetwork::changeToSet(NNUEAccumulator &acc, Player player, int oldN, int newN) const
+{
+    subFeature(acc, player2Index(PL_White), toSetFeature(PL_White, player, oldN));
+    addFeature(acc, player2Index(PL_White), toSetFeature(PL_White, player, newN));
+    subFeature(acc, player2Index(PL_Black), toSetFeature(PL_Black, player, oldN));
+    addFeature(acc, player2Index(PL_Black), toSetFeature(PL_Black, player, newN));
+}
+
+void NNUENetwork::refresh(NNUEAccumulator &acc, const Board &board) const
+{
+    clear(acc);
+
+    for (int i = 0; i < MAXPOSITIONS; i++)
+        if (board.getPosition(i) != PL_None) {
+            addPiece(acc, board.getPosition(i), i);
+        }
+
+    addToSet(acc, PL_White, board.getNPiecesToSet(PL_White));
+    addToSet(acc, PL_Black, board.getNPiecesToSet(PL_Black));
+}
+
+void NNUENetwork::update(NNUEAccumulator &acc, const Board &board, const Move &m) const
+{
+    const Player player = board.getCurrentPlayer();
+
+    switch (m.mode) {
+    case Move::Mode_Set:
+    {
+        const int nToSet = board.getNPiecesToSet(player);
+
+        addPiece(acc, player, m.newPos);
+        changeToSet(acc, player, nToSet, nToSet - 1);
+    }
+    break;
+
+    case Move::Mode_Move:
+        removePiece(acc, player, m.oldPos);
+        addPiece(acc, player, m.newPos);
+        break;
+    }
+
+    for (int i = 0; i < m.takes.size(); i++) {
+        removePiece(acc, opponent(player), m.takes[i]);
+    }
+}
+
+// --- forward pass ---
+
+float NNUENetwork::evaluate(const NNUEAccumulator &acc, Player toMove) const
+{
+    const int16_t *input[2] = { acc.v[player2Index(toMove)], acc.v[player2Index(opponent(toMove))] };
+
+    int32_t sum = b2;
+
+#if defined(__AVX2__)
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i qa = _mm256_set1_epi16(NNUE_QA);
+    __m256i s = _mm256_setzero_si256();
+
+    for (int half = 0; half < 2; half++)
+        for (int i = 0; i < NNUE_HIDDEN; i += 16) {
+            __m256i x = _mm256_loadu_si256((const __m256i *)&input[half][i]);
+            x = _mm256_max_epi16(_mm256_min_epi16(x, qa), zero);
+            __m256i w = _mm256_loadu_si256((const __m256i *)&w2[half * NNUE_HIDDEN + i]);
+            s = _mm256_add_epi32(s, _mm256_madd_epi16(x, w));
+        }
+
+    int32_t lanes[8];
+    _mm256_storeu_si256((__m256i *)lanes, s);
+    for (int i = 0; i < 8; i++)
+        sum += lanes[i];
+#elif defined(__SSE2__)
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i qa = _mm_set1_epi16(NNUE_QA);
+    __m128i s = _mm_setzero_si128();
+
+    for (int half = 0; half < 2; half++)
+        for (int i = 0; i < NNUE_HIDDEN; i += 8) {
+            __m128i x = _mm_loadu_si128((const __m128i *)&input[half][i]);
+            x = _mm_max_epi16(_mm_min_epi16(x, qa), zero);
+            __m128i w = _mm_loadu_si128((const __m128i *)&w2[half * NNUE_HIDDEN + i]);
+            s = _mm_add_epi32(s, _mm_madd_epi16(x, w));
+        }
+
+    int32_t lanes[4];
+    _mm_storeu_si128((__m128i *)lanes, s);
+    for (int i = 0; i < 4; i++)
+        sum += lanes[i];
+#else
+    for (int half = 0; half < 2; half++)
+        for (int i = 0; i < NNUE_HIDDEN; i++) {
+            int x = input[half][i];
+            if (x < 0)
+                x = 0;
+            if (x > NNUE_QA)
+                x = NNUE_QA;
+
+            sum += x * w2[half * NNUE_HIDDEN + i];
+        }
+#endif
+
+    return float(sum) / (NNUE_QA * NNUE_QB);
+}
+
+// --- file I/O ---
+
+// Network files are exchanged between machines, hence all numbers are stored little-endian.
+
+static void putNumber(std::vector<unsigned char> &buf, uint32_t v, int nBytes)
+{
+    for (int i = 0; i < nBytes; i++)
+        buf.push_back((v >> (8 * i)) & 0xFF);
+}
+
+static uint32_t getNumber(const unsigned char *&p, int nBytes)
+{
+    uint32_t v = 0;
+    for (int i = 0; i < nBytes; i++)
+        v |= uint32_t(*p++) << (8 * i);
+    return v;
+}
+
+enum
+{
+    HEADER_SIZE = 8 + 4 * 4,
+    PARAMETERS_SIZE = (NNUE_INPUTS * NNUE_HIDDEN + NNUE_HIDDEN + 2 * NNUE_HIDDEN) * 2 + 4
+};
+
+std::string NNUENetwork::fileName(int boardPreset)
+{
+    char buf[32];
+    sprintf(buf, "board-%d.nnue", boardPreset);
+    return buf;
+}
+
+bool NNUENetwork::save(const std::string &filename) const
+{
+    std::vector<unsigned char> buf(MAGIC, MAGIC + sizeof(MAGIC));
+    putNumber(buf, VERSION, 4);
+    putNumber(buf, m_boardPreset, 4);
+    putNumber(buf, NNUE_INPUTS, 4);
+    putNumber(buf, NNUE_HIDDEN, 4);
+
+    for (int f = 0; f < NNUE_INPUTS; f++)
+        for (int i = 0; i < NNUE_HIDDEN; i++)
+            putNumber(buf, uint16_t(w1[f][i]), 2);
+    for (int i = 0; i < NNUE_HIDDEN; i++)
+        putNumber(buf, uint16_t(b1[i]), 2);
+    for (int i = 0; i < 2 * NNUE_HIDDEN; i++)
+        putNumber(buf, uint16_t(w2[i]), 2);
+    putNumber(buf, uint32_t(b2), 4);
+
+    FILE *fh = fopen(filename.c_str(), "wb");
+    if (fh == NULL)
+        return false;
+
+    bool ok = (fwrite(&buf[0], buf.size(), 1, fh) == 1);
+    ok = (fclose(fh) == 0) && ok;
+
+    return ok;
+}
+
+bool NNUENetwork::load(const std::string &filename)
+{
+    FILE *fh = fopen(filename.c_str(), "rb");
+    if (fh == NULL)
+        return false;
+
+    std::vector<unsigned char> buf(HEADER_SIZE + PARAMETERS_SIZE);
+    bool ok = (fread(&buf[0], buf.size(), 1, fh) == 1);
+    fclose(fh);
+
+    if (!ok || memcmp(&buf[0], MAGIC, sizeof(MAGIC)) != 0)
+        return false;
+
+    const unsigned char *p = &buf[sizeof(MAGIC)];
+    const int version = getNumber(p, 4);
+    const int preset = getNumber(p, 4);
+    const int nInputs = getNumber(p, 4);
+    const int nHidden = getNumber(p, 4);
+
+    if (version != VERSION || nInputs != NNUE_INPUTS || nHidden != NNUE_HIDDEN)
+        return false;
+
+    m_boardPreset = preset;
+
+    for (int f = 0; f < NNUE_INPUTS; f++)
+        for (int i = 0; i < NNUE_HIDDEN; i++)
+            w1[f][i] = int16_t(getNumber(p, 2));
+    for (int i = 0; i < NNUE_HIDDEN; i++)
+        b1[i] = int16_t(getNumber(p, 2));
+    for (int i = 0; i < 2 * NNUE_HIDDEN; i++)
+        w2[i] = int16_t(getNumber(p, 2));
+    b2 = int32_t(getNumber(p, 4));
+
+    return true;
+}
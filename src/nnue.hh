@@ -0,0 +1,125 @@
+/***************************************************************************
+  This file is part of Morris.
+  Copyright (C) 2009 Dirk Farin <dirk.farin@gmail.com>
+
+  Morris is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+***************************************************************************/
+
+
+#ifndef NNUE_HH
+#define NNUE_HH
+
+#include "util.hh"
+#include "constants.hh"
+
+#include <string>
+#include <stdint.h>
+#include <boost/shared_ptr.hpp>
+
+/* A small neural network for the position evaluation with an efficiently updatable
+   first layer (NNUE).
+
+   The input features are the pieces on each position and the number of pieces each
+   player still has to set. They are seen from two perspectives (white and black),
+   i.e., whether a piece is an own or an opponent piece. The first layer is computed
+   for both perspectives with shared weights. Since only a few features change with
+   a move, the search keeps one accumulator per ply and derives it from the parent's
+   with update(). The output layer takes the clipped accumulators, side to move
+   first, and computes the evaluation in units of pieces, like the static evaluation:
+   the trainer fits the outcome logit and divides the output layer by the logit of
+   one piece of material (see morris-nnue-train).
+
+   All computations are done in fixed-point: 16-bit accumulators (QA=127 corresponds
+   to an activation of 1), 16-bit output weights (QB=64 corresponds to 1).
+ */
+
+enum
+{
+    NNUE_HIDDEN = 32,
+    NNUE_INPUTS = 2 * MAXPOSITIONS + 2 * (MAXPIECES + 1),
+    NNUE_QA = 127,
+    NNUE_QB = 64
+};
+
+struct NNUEAccumulator
+{
+    int16_t v[2][NNUE_HIDDEN]; // [player2Index(perspective)]
+};
+
+class NNUENetwork
+{
+public:
+    NNUENetwork();
+
+    // Load/save a network file. Returns false on errors.
+    bool load(const std::string &filename);
+    bool save(const std::string &filename) const;
+
+    // The file name (without directory) of the network for a board preset.
+    static std::string fileName(int boardPreset);
+
+    // The board preset (see BoardSpec::BoardPreset) the network was trained for.
+    int getBoardPreset() const
+    {
+        return m_boardPreset;
+    }
+    void setBoardPreset(int preset)
+    {
+        m_boardPreset = preset;
+    }
+
+    // feature indices from the view of 'perspective'
+    static int pieceFeature(Player perspective, Player piece, int pos)
+    {
+        return (piece == perspective ? 0 : MAXPOSITIONS) + pos;
+    }
+    static int toSetFeature(Player perspective, Player player, int n)
+    {
+        return 2 * MAXPOSITIONS + (player == perspective ? 0 : MAXPIECES + 1) + n;
+    }
+
+    // --- accumulator ---
+
+    void clear(NNUEAccumulator &) const;
+    void addPiece(NNUEAccumulator &, Player piece, int pos) const;
+    void removePiece(NNUEAccumulator &, Player piece, int pos) const;
+    void addToSet(NNUEAccumulator &, Player player, int n) const;
+    void changeToSet(NNUEAccumulator &, Player player, int oldN, int newN) const;
+
+    // Compute the accumulator of the board from scratch.
+    void refresh(NNUEAccumulator &, const class Board &) const;
+
+    // Change the accumulator of the board into that of the position after the move.
+    void update(NNUEAccumulator &, const class Board &, const class Move &) const;
+
+    // Evaluation in units of pieces from the view of the player to move.
+    float evaluate(const NNUEAccumulator &, Player toMove) const;
+
+    // --- parameters (for the trainer) ---
+
+    int16_t w1[NNUE_INPUTS][NNUE_HIDDEN];
+    int16_t b1[NNUE_HIDDEN];
+    int16_t w2[2 * NNUE_HIDDEN];
+    int32_t b2;
+
+private:
+    int m_boardPreset;
+
+    void addFeature(NNUEAccumulator &, int perspectiveIdx, int feature) const;
+    void subFeature(NNUEAccumulator &, int perspectiveIdx, int feature) const;
+};
+
+typedef boost::shared_ptr<NNUENetwork> nnue_ptr;
+
+#endif
@@ -23,6 +23,8 @@
 #include "rules.hh"
 #include "threadtunnel.hh"
 
+class GameControl;
+
 /* The main interface for all kinds of players.
 
    Communication of the player to the outside world is usually through
@@ -71,6 +73,12 @@ public:
     virtual void resetGame()
     {
     }
+
+    /* Called before startMove() with the remaining time of this player if the game
+       is played with a clock (zero otherwise). */
+    virtual void setGameClock(int remainingMSecs, int incrementMSecs)
+    {
+    }
     virtual void startMove(const Board &current, int moveID) = 0; // start this player's move
     virtual void forceMove()
     {
@@ -79,7 +87,8 @@ public:
     {
     } // stop thinking and do not move, will join the algo-thread
 
-    virtual void notifyWinner(Player p)
+    /* Called at the end of a game. The game history can be obtained from 'control'. */
+    virtual void notifyWinner(Player p, const GameControl &control)
     {
     }
 
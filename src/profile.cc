@@ -0,0 +1,66 @@
+/***************************************************************************
+  This file is part of Morris.
+  Copyright (C) 2009 Dirk Farin <dirk.farin@gmail.com>
+
+  Morris is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+***************************************************************************/
+
+
+#include "profile.hh"
+
+#if ENABLE_PROFILING
+
+#include <string.h>
+#include <iomanip>
+
+thread_local ProfileData profileData;
+
+static const char *const counterNames[Prof_NCOUNTERS] =
+{
+    "generateMoves",
+    "generateTakes",
+    "Eval",
+    "TT search",
+    "TT save",
+    "getBoardID_Symmetric",
+    "getSymmetricKey"
+};
+
+void resetProfile()
+{
+    memset(&profileData, 0, sizeof(profileData));
+}
+
+void printProfile(std::ostream &ostr)
+{
+    std::ios::fmtflags flags = ostr.flags();
+
+    ostr << "profile:   " << std::setw(22) << std::left << "function" << std::right
+         << std::setw(14) << "calls"
+         << std::setw(16) << "cycles"
+         << std::setw(12) << "cycles/call" << "\n";
+
+    for (int i = 0; i < Prof_NCOUNTERS; i++) {
+        const unsigned long long calls = profileData.calls[i];
+
+        ostr << "profile:   " << std::setw(22) << std::left << counterNames[i] << std::right
+             << std::setw(14) << calls
+             << std::setw(16) << profileData.cycles[i]
+             << std::setw(12) << (calls ? profileData.cycles[i] / calls : 0) << "\n";
+    }
+
+    ostr.flags(flags);
+}
+
+#endif
@@ -0,0 +1,116 @@
+/***************************************************************************
+  This file is part of Morris.
+  Copyright (C) 2009 Dirk Farin <dirk.farin@gmail.com>
+
+  Morris is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+***************************************************************************/
+
+
+#ifndef PROFILE_HH
+#define PROFILE_HH
+
+#include "config.h"
+
+/* Instrumentation of the hot functions of the search. Each instrumented function
+   counts its calls and the processor cycles spent in it (inclusive of nested
+   instrumented functions). The counters are kept per thread, such that each
+   search thread can print a summary of its own search.
+
+   The instrumentation is only compiled in with 'configure --enable-profiling'.
+   Otherwise, the macros below expand to nothing.
+ */
+
+#ifndef ENABLE_PROFILING
+#define ENABLE_PROFILING 0
+#endif
+
+enum ProfileCounter
+{
+    Prof_GenerateMoves,
+    Prof_GenerateTakes,
+    Prof_Eval,
+    Prof_TTSearch,
+    Prof_TTSave,
+    Prof_BoardIDSymmetric,
+    Prof_SymmetricKey,
+    Prof_NCOUNTERS
+};
+
+#if ENABLE_PROFILING
+
+#include <iostream>
+
+#if defined(__i386__) || defined(__x86_64__)
+#include <x86intrin.h>
+#else
+#include <time.h>
+#endif
+
+struct ProfileData
+{
+    unsigned long long calls[Prof_NCOUNTERS];
+    unsigned long long cycles[Prof_NCOUNTERS];
+};
+
+extern thread_local ProfileData profileData;
+
+inline unsigned long long readCycleCounter()
+{
+#if defined(__i386__) || defined(__x86_64__)
+    return __rdtsc();
+#else
+    // nanoseconds instead of cycles
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+#endif
+}
+
+class ProfileScope
+{
+public:
+    ProfileScope(ProfileCounter c) : m_counter(c), m_start(readCycleCounter())
+    {
+    }
+
+    ~ProfileScope()
+    {
+        profileData.calls[m_counter]++;
+        profileData.cycles[m_counter] += readCycleCounter() - m_start;
+    }
+
+private:
+    ProfileCounter m_counter;
+    unsigned long long m_start;
+};
+
+// Clear the counters of the current thread.
+void resetProfile();
+
+// Print the counters of the current thread.
+void printProfile(std::ostream &);
+
+#define PROFILE(counter) ProfileScope profileScope_(counter)
+#define PROFILE_RESET() resetProfile()
+#define PROFILE_REPORT() printProfile(std::cerr)
+
+#else
+
+#define PROFILE(counter)
+#define PROFILE_RESET()
+#define PROFILE_REPORT()
+
+#endif
+
+#endif
@@ -17,6 +17,7 @@
 ***************************************************************************/
 
 #include "rules.hh"
+#include "profile.hh"
 
 std::string writeMove(const Move &m, boardspec_ptr spec)
 {
@@ -37,6 +38,22 @@ std::string writeMove(const Move &m, boardspec_ptr spec)
     return str;
 }
 
+Move permuteMove(const Move &m, const BoardSpec::Permutation &perm)
+{
+    Move pm = m;
+
+    if (m.mode == Move::Mode_Move) {
+        pm.oldPos = perm[m.oldPos];
+    }
+    pm.newPos = perm[m.newPos];
+
+    for (int i = 0; i < m.takes.size(); i++) {
+        pm.takes[i] = perm[m.takes[i]];
+    }
+
+    return pm;
+}
+
 RuleSpec::RuleSpec()
 {
     laskerVariant = false;
@@ -196,12 +213,15 @@ void RuleSpec::addTakesToMoveIfMillClosed(std::vector<Move> &output,
             nMills = 1;
         }
 
+        PROFILE(Prof_GenerateTakes);
         generateTakes(output, m, currBoard, nMills);
     }
 }
 
 void RuleSpec::generateMoves(std::vector<Move> &output, const Board &currBoard) const
 {
+    PROFILE(Prof_GenerateMoves);
+
     const bool maySet = (currBoard.getNPiecesToSet() > 0);
     const bool mayMove = (currBoard.getNPiecesToSet() == 0) || laskerVariant;
     const bool mayFly = mayJump && (currBoard.getNPiecesLeft() == 3);
@@ -465,21 +485,27 @@ rulespec_ptr RuleSpec::createPresetRule(enum RulePreset p)
 }
 
 BoardID RuleSpec::getBoardID(const Board &board) const
+{
+    return getBoardID(board, board.getPieceBits(PL_White), board.getPieceBits(PL_Black));
+}
+
+BoardID RuleSpec::getBoardID(const Board &board, PositionBits white, PositionBits black) const
 {
     BoardID id = 0;
     id += board.getNPiecesToSet(PL_White);
     id *= nPieces + 1;
     id += board.getNPiecesToSet(PL_Black);
 
+    // positions are base-3 digits: empty=0, white=1, black=2
+
     const int nPos = boardSpec->nPositions();
     for (int p = 0; p < nPos; p++) {
         id *= 3;
 
-        int pl = board.getPosition(p);
-        if (pl < 0)
-            pl = 2;
-
-        id += pl;
+        if (white & positionBit(p))
+            id += 1;
+        else if (black & positionBit(p))
+            id += 2;
     }
 
     id *= 2;
@@ -488,23 +514,143 @@ BoardID RuleSpec::getBoardID(const Board &board) const
     return id;
 }
 
-BoardID RuleSpec::getBoardID_Symmetric(const Board &board) const
+void RuleSpec::getBoardFromID(BoardID id, Board &board) const
+{
+    board.reset(nPieces);
+
+    Player current = (id % 2) ? PL_White : PL_Black; // see player2Index()
+    id /= 2;
+
+    for (int p = boardSpec->nPositions() - 1; p >= 0; p--) {
+        const int digit = id % 3;
+        id /= 3;
+
+        board.setPosition_noHash(p, digit == 0 ? PL_None : digit == 1 ? PL_White : PL_Black);
+    }
+
+    const int nToSetBlack = id % (nPieces + 1);
+    const int nToSetWhite = id / (nPieces + 1);
+
+    board.setState(current, nToSetWhite, nToSetBlack);
+}
+
+bool RuleSpec::hasUniqueBoardIDs() const
+{
+    // the largest ID is (nPieces+1)^2 * 3^nPositions * 2 - 1, see getBoardID()
+
+    const BoardID maxID = ~BoardID(0);
+    BoardID nIDs = 2 * (nPieces + 1) * (nPieces + 1);
+
+    for (int p = 0; p < boardSpec->nPositions(); p++) {
+        if (nIDs > maxID / 3)
+            return false;
+
+        nIDs *= 3;
+    }
+
+    return true;
+}
+
+// The base-3 digit of the position given by the single bit 'pos'.
+static inline int boardIDDigit(PositionBits white, PositionBits black, PositionBits pos)
+{
+    if (white & pos)
+        return 1;
+    if (black & pos)
+        return 2;
+    return 0;
+}
+
+BoardID RuleSpec::getBoardID_Symmetric(const Board &board, int *permutationIdx) const
+{
+    PROFILE(Prof_BoardIDSymmetric);
+
+    PositionBits white, black;
+    int idx = getCanonicalPermutation(board, white, black);
+
+    if (permutationIdx)
+        *permutationIdx = idx;
+
+    return getBoardID(board, white, black);
+}
+
+// 64-bit finalizer from MurmurHash3, to spread the bits of the canonical board.
+static inline Key mixBits(Key k)
+{
+    k ^= k >> 33;
+    k *= 0xff51afd7ed558ccdULL;
+    k ^= k >> 33;
+    k *= 0xc4ceb9fe1a85ec53ULL;
+    k ^= k >> 33;
+    return k;
+}
+
+Key RuleSpec::getSymmetricKey(const Board &board, int *permutationIdx) const
+{
+    PROFILE(Prof_SymmetricKey);
+
+    PositionBits white, black;
+    int idx = getCanonicalPermutation(board, white, black);
+
+    if (permutationIdx)
+        *permutationIdx = idx;
+
+    Key meta = board.getNPiecesToSet(PL_White);
+    meta = meta * 256 + board.getNPiecesToSet(PL_Black);
+    meta = meta * 2 + player2Index(board.getCurrentPlayer());
+
+    return mixBits(white ^ mixBits(black ^ mixBits(meta)));
+}
+
+int RuleSpec::getCanonicalPermutation(const Board &board, PositionBits &bestWhite, PositionBits &bestBlack) const
 {
     const std::vector<BoardSpec::Permutation> &permutations = boardSpec->getPermutations();
 
-    // Compute all symmetric permutations of the board position and determine the board ID for each.
-    // Return the lowest ID.
+    /* Find the permutation with the lowest ID of all permutations of the board position. Since position 0 is the
+       most significant digit of the ID, the permutation with the lowest ID is the one with the
+       smallest digit at the first position in which the permuted boards differ. Hence, the
+       permutations can be compared on the bit-sets without computing their IDs.
+       On boards on which the ID wraps around (see hasUniqueBoardIDs()), this is the lowest
+       ID before the wrap-around, which need not be the lowest of the wrapped IDs.
+     */
+
+    const PositionBits white = board.getPieceBits(PL_White);
+    const PositionBits black = board.getPieceBits(PL_Black);
+
+    bestWhite = boardSpec->permuteBits(0, white);
+    bestBlack = boardSpec->permuteBits(0, black);
+    int bestIdx = 0;
 
-    Board b = board; // TODO: setting only the meta-information would be faster (next player, pieces to set)
-    BoardID id;
-    for (int i = 0; i < permutations.size(); i++) {
-        for (int p = 0; p < boardSpec->nPositions(); p++)
-            b.setPosition_noHash(permutations[i][p], board.getPosition(p));
+    for (int i = 1; i < permutations.size(); i++) {
+        const PositionBits w = boardSpec->permuteBits(i, white);
+        const PositionBits b = boardSpec->permuteBits(i, black);
 
-        BoardID newid = getBoardID(b);
-        if (i == 0 || newid < id)
-            id = newid;
+        PositionBits diff = (w ^ bestWhite) | (b ^ bestBlack);
+        if (diff == 0)
+            continue;
+
+        const PositionBits first = diff & (~diff + 1); // lowest differing position
+
+        if (boardIDDigit(w, b, first) < boardIDDigit(bestWhite, bestBlack, first)) {
+            bestWhite = w;
+            bestBlack = b;
+            bestIdx = i;
+        }
     }
 
-    return id;
+    return bestIdx;
+}
+
+Key RuleSpec::getRulesKey() const
+{
+    Key key = boardSpec->getBoardPresetID();
+    key = key * 64 + boardSpec->nPositions();
+    key = key * 64 + boardSpec->nMills();
+    key = key * 32 + nPieces;
+    key = key * 2 + laskerVariant;
+    key = key * 2 + mayJump;
+    key = key * 2 + mayTakeMultiple;
+    key = key * 2 + mayTakeFromMillsAlways;
+
+    return key;
 }
@@ -28,6 +28,10 @@ std::string writeMove(const Move &m, boardspec_ptr spec);
 
 typedef unsigned long long BoardID; // a unique ID for a specific board-configuration
 
+/* Map all positions of the move through the permutation (see BoardSpec::getPermutations()).
+ */
+Move permuteMove(const Move &m, const BoardSpec::Permutation &);
+
 typedef boost::shared_ptr<class RuleSpec> rulespec_ptr;
 
 /* The rule-specification class manages the various variants of the rules.
@@ -81,11 +85,28 @@ public:
     bool tieBetweenBothPlayers(const Board &) const;
 
     // Get a unique ID for the current board.
+    // NOTE: on boards with many positions (Polygon6), the ID does not fit into 64 bits and
+    // wraps around. It is then neither unique nor invertible, see hasUniqueBoardIDs().
     BoardID getBoardID(const Board &board) const;
 
+    // Reconstruct the board from its ID (the inverse of getBoardID()).
+    void getBoardFromID(BoardID id, Board &board) const;
+
+    // Whether all board IDs of these rules fit into a BoardID, i.e., whether they are unique
+    // and can be inverted with getBoardFromID().
+    bool hasUniqueBoardIDs() const;
+
     // Get a unique ID for the current board, considering symmetries. I.e. a similar situation,
     // in which the board is just rotated, mirrored, or otherwise permuted receives the same ID.
-    BoardID getBoardID_Symmetric(const Board &board) const;
+    // Optionally, the index of the permutation that gives the canonical board is returned.
+    BoardID getBoardID_Symmetric(const Board &board, int *permutationIdx = NULL) const;
+
+    // A hash key that is identical for all symmetric boards, like getBoardID_Symmetric().
+    // The key is cheaper to compute than the ID and covers all board sizes.
+    Key getSymmetricKey(const Board &board, int *permutationIdx = NULL) const;
+
+    // A key that identifies the rule configuration, i.e., the board and the rule variations.
+    Key getRulesKey() const;
 
     // --- move generator ---
 
@@ -126,6 +147,13 @@ private:
          to the set (without takes).
       */
     void addTakesToMoveIfMillClosed(std::vector<Move> &output, const Move &m, const class Board &currentBoard) const;
+
+    /* Determine the permutation that maps the board to its canonical form (the one with the
+       lowest board ID) and return the permuted piece positions. */
+    int getCanonicalPermutation(const Board &board, PositionBits &white, PositionBits &black) const;
+
+    // The board ID for the given piece configuration and the meta-information of 'board'.
+    BoardID getBoardID(const Board &board, PositionBits white, PositionBits black) const;
 };
 
 /* NOTE: this function is defined inline, because it is used in the time critical
@@ -0,0 +1,96 @@
+/***************************************************************************
+  This file is part of Morris.
+  Copyright (C) 2009 Dirk Farin <dirk.farin@gmail.com>
+
+  Morris is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+***************************************************************************/
+
+
+#ifndef SCORE_HH
+#define SCORE_HH
+
+/* Search scores are fixed-point integers in units of 1/SCORE_SCALE pieces, relative
+   to the player to move.
+
+   Won and lost positions have scores beyond +-SCORE_MATE_BOUND that encode the distance
+   to the end of the game: a position in which the player to move has lost is scored
+   -SCORE_MATE, and a position that is won (lost) in n plies SCORE_MATE-n (-SCORE_MATE+n).
+   Since the distance is counted from the scored position, a score is converted with
+   scoreToParent() when it is passed up one ply, and a bound with boundToChild() when
+   it is passed down. Scores stored in the transposition table are thus independent
+   of the depth at which the position was found.
+ */
+typedef int Score;
+
+enum
+{
+    SCORE_SCALE = 100,
+    SCORE_MATE = 30000,
+    SCORE_MATE_BOUND = SCORE_MATE - 1000, // longest encoded distance: 1000 plies
+    SCORE_INFINITE = SCORE_MATE + 1       // larger than any score, for the search window
+};
+
+inline bool isMateScore(Score s)
+{
+    return s > SCORE_MATE_BOUND || s < -SCORE_MATE_BOUND;
+}
+
+// Number of plies until the end of the game, for mate scores.
+inline int matePlies(Score s)
+{
+    return SCORE_MATE - (s < 0 ? -s : s);
+}
+
+// The score of a child position, seen from the parent position.
+inline Score scoreToParent(Score s)
+{
+    /**/ if (s > SCORE_MATE_BOUND)
+        s--;
+    else if (s < -SCORE_MATE_BOUND)
+        s++;
+
+    return -s;
+}
+
+// The search bound of a position, seen from a child position.
+inline Score boundToChild(Score s)
+{
+    /**/ if (s > SCORE_MATE_BOUND)
+        s++;
+    else if (s < -SCORE_MATE_BOUND)
+        s--;
+
+    return -s;
+}
+
+/* Convert an evaluation in pieces to a score. Evaluations beyond the range of normal
+   scores are clipped, such that they are never taken as mate scores. */
+inline Score scoreFromPieces(float pieces)
+{
+    const float s = pieces * SCORE_SCALE;
+
+    if (s >= SCORE_MATE_BOUND)
+        return SCORE_MATE_BOUND;
+    if (s <= -SCORE_MATE_BOUND)
+        return -SCORE_MATE_BOUND;
+
+    return Score(s < 0 ? s - 0.5f : s + 0.5f);
+}
+
+inline float scoreToPieces(Score s)
+{
+    return float(s) / SCORE_SCALE;
+}
+
+#endif
@@ -0,0 +1,94 @@
+/***************************************************************************
+  This file is part of Morris.
+  Copyright (C) 2009 Dirk Farin <dirk.farin@gmail.com>
+
+  Morris is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+***************************************************************************/
+
+
+#ifndef SEARCHINFO_HH
+#define SEARCHINFO_HH
+
+#include "board.hh"
+#include "score.hh"
+
+#include <iostream>
+#include <iomanip>
+
+/* Statistics of one completed iteration of the iterative-deepening search.
+   Node and table counts are accumulated from the start of the search.
+ */
+struct SearchInfo
+{
+    int depth;
+    int selDepth;         // deepest ply that was reached
+    long long nodes;      // searched nodes, including leaves
+    long long leafEvals;  // calls of the evaluation function
+    int timeMS;           // since the start of the search
+
+    Score score;          // normalized for white
+    Move bestMove;
+
+    long long ttLookups;
+    long long ttHits;       // lookups that found the position
+    long long ttCollisions; // lookups that found another position in the slot
+    float ttFill;           // estimated fraction of used table entries
+
+    float branchingFactor;  // nodes of this iteration relative to the previous one
+
+    long long nodesPerSecond() const
+    {
+        return timeMS > 0 ? nodes * 1000 / timeMS : 0;
+    }
+
+    float ttHitRate() const
+    {
+        return ttLookups ? float(ttHits) / ttLookups : 0;
+    }
+
+    float ttCollisionRate() const
+    {
+        return ttLookups ? float(ttCollisions) / ttLookups : 0;
+    }
+};
+
+/* If this environment variable is set, the GUI and the command-line tools append
+   the statistics of each iteration to the named file. */
+#define SEARCH_LOG_VARIABLE "MORRIS_SEARCH_LOG"
+
+// One line of text, suitable for log files.
+inline std::ostream &operator<<(std::ostream &ostr, const SearchInfo &info)
+{
+    std::ios::fmtflags flags = ostr.flags();
+    std::streamsize precision = ostr.precision();
+
+    ostr << std::fixed << std::setprecision(1)
+         << "depth " << info.depth << "/" << info.selDepth
+         << " score " << scoreToPieces(info.score)
+         << " move " << info.bestMove
+         << " nodes " << info.nodes
+         << " evals " << info.leafEvals
+         << " nps " << info.nodesPerSecond()
+         << " tt-hit " << 100 * info.ttHitRate() << "%"
+         << " tt-coll " << 100 * info.ttCollisionRate() << "%"
+         << " tt-fill " << 100 * info.ttFill << "%"
+         << " bf " << info.branchingFactor
+         << " time " << info.timeMS << "ms";
+
+    ostr.flags(flags);
+    ostr.precision(precision);
+    return ostr;
+}
+
+#endif
@@ -20,6 +20,7 @@
 #define THREADTUNNEL_HH
 
 #include "board.hh"
+#include "searchinfo.hh"
 
 /* The thread-tunnel provides the interface through which the players
    communicate to the main application. The thread-tunnel object is
@@ -49,6 +50,11 @@ public:
     {
     }
 
+    // Statistics after each completed search iteration.
+    virtual void reportSearchInfo(const SearchInfo &)
+    {
+    }
+
     // Send move to main application.
     virtual void doMove(Move m, int moveID) = 0;
 
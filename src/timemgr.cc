@@ -0,0 +1,132 @@
+/***************************************************************************
+  This file is part of Morris.
+  Copyright (C) 2009 Dirk Farin <dirk.farin@gmail.com>
+
+  Morris is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+***************************************************************************/
+
+
+#include "timemgr.hh"
+
+#include <algorithm>
+
+static const int MOVES_TO_GO = 20;       // expected number of own moves until the end of the game
+static const int CLOCK_SAFETY_MS = 50;   // never plan to use the last milliseconds on the clock
+static const float SOFT_FRACTION = 0.5;  // soft limit relative to the hard limit for fixed time per move
+static const float MAX_OVERSHOOT = 4.0;  // hard limit relative to the planned time for game clocks
+
+static const float BESTMOVE_CHANGE_FACTOR = 1.5;
+static const Score SCORE_DROP = SCORE_SCALE / 2; // score drop that is considered dangerous
+static const float SCORE_DROP_FACTOR = 1.3;
+static const int STABLE_ITERATIONS = 4;  // iterations without best-move change to consider the move stable
+static const float STABLE_FACTOR = 0.7;
+static const float MIN_SCALE = 0.3;
+static const float MAX_SCALE = 3.0;
+
+static int timeDiff_ms(const struct timeval &t1,
+                       const struct timeval &t2)
+{
+    const int diffSec = t2.tv_sec - t1.tv_sec;
+    const int diffUS = t2.tv_usec - t1.tv_usec;
+
+    const int diffMS = diffSec * 1000 + diffUS / 1000;
+
+    return diffMS;
+}
+
+TimeManager::TimeManager()
+{
+    m_maxMSecs = 1000;
+    m_clockRemainingMSecs = 0;
+    m_clockIncrementMSecs = 0;
+
+    startMove();
+}
+
+void TimeManager::setGameClock(int remainingMSecs, int incrementMSecs)
+{
+    m_clockRemainingMSecs = remainingMSecs;
+    m_clockIncrementMSecs = incrementMSecs;
+}
+
+void TimeManager::startMove()
+{
+    gettimeofday(&m_startTime, NULL);
+
+    if (m_clockRemainingMSecs > 0) {
+        const int available = std::max(m_clockRemainingMSecs - CLOCK_SAFETY_MS, 1);
+
+        m_baseLimitMS = available / MOVES_TO_GO + m_clockIncrementMSecs * 3 / 4;
+        m_hardLimitMS = std::min(int(m_baseLimitMS * MAX_OVERSHOOT), available / 4 + m_clockIncrementMSecs);
+        m_hardLimitMS = std::min(m_hardLimitMS, available);
+        m_baseLimitMS = std::min(m_baseLimitMS, m_hardLimitMS);
+    } else {
+        m_hardLimitMS = m_maxMSecs;
+        m_baseLimitMS = int(m_maxMSecs * SOFT_FRACTION);
+    }
+
+    m_softLimitMS = m_baseLimitMS;
+    m_scale = 1.0;
+    m_stableIterations = 0;
+    m_lastBestMove.reset();
+    m_lastEval = 0;
+}
+
+void TimeManager::iterationFinished(int depth, const Move &bestMove, Score eval)
+{
+    if (depth > 1) {
+        if (bestMove == m_lastBestMove) {
+            m_stableIterations++;
+        } else {
+            m_stableIterations = 0;
+            m_scale *= BESTMOVE_CHANGE_FACTOR;
+        }
+
+        if (eval < m_lastEval - SCORE_DROP) {
+            m_scale *= SCORE_DROP_FACTOR;
+        }
+
+        if (m_stableIterations >= STABLE_ITERATIONS) {
+            m_scale *= STABLE_FACTOR;
+        }
+
+        m_scale = std::max(MIN_SCALE, std::min(MAX_SCALE, m_scale));
+        m_softLimitMS = std::min(int(m_baseLimitMS * m_scale), m_hardLimitMS);
+    }
+
+    m_lastBestMove = bestMove;
+    m_lastEval = eval;
+}
+
+int TimeManager::elapsedMS() const
+{
+    struct timeval now;
+    gettimeofday(&now, NULL);
+
+    return timeDiff_ms(m_startTime, now);
+}
+
+float TimeManager::progress(int elapsed) const
+{
+    if (m_softLimitMS <= 0) {
+        return 1.0;
+    }
+
+    float perc = elapsed;
+    perc /= m_softLimitMS;
+    if (perc > 1.0)
+        perc = 1.0;
+
+    return perc;
+}
@@ -0,0 +1,108 @@
+/***************************************************************************
+  This file is part of Morris.
+  Copyright (C) 2009 Dirk Farin <dirk.farin@gmail.com>
+
+  Morris is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+***************************************************************************/
+
+
+#ifndef TIMEMGR_HH
+#define TIMEMGR_HH
+
+#include "board.hh"
+#include "score.hh"
+#include <sys/time.h>
+
+/* The time manager decides how long the AI may think about a move.
+   When a move is started, two limits are computed:
+   - The soft limit is the planned thinking time. Iterative deepening does not
+     start a new iteration once it has passed.
+   - The hard limit is the time at which the search is aborted in any case.
+
+   Without a game clock, the hard limit is the configured maximum time per move.
+   With a game clock, both limits are derived from the remaining time and the
+   increment per move.
+
+   After each iteration, the soft limit is adapted: it is extended when the best
+   move changed or the score dropped, and reduced when the best move has been stable
+   for some iterations. It never exceeds the hard limit.
+
+   Checking the time is a system call, hence the search only does it every
+   POLL_INTERVAL nodes.
+ */
+class TimeManager
+{
+public:
+    TimeManager();
+
+    enum
+    {
+        POLL_INTERVAL = 1024 // number of search nodes between two time checks (power of two)
+    };
+
+    // --- configuration ---
+
+    void setMaxTime_msec(int msecs)
+    {
+        m_maxMSecs = msecs;
+    }
+    int askMaxTime_msec() const
+    {
+        return m_maxMSecs;
+    }
+
+    /* Use a game clock with the given remaining time and increment per move.
+       Set 'remainingMSecs' to zero to return to a fixed time per move. */
+    void setGameClock(int remainingMSecs, int incrementMSecs);
+
+    // --- during the search ---
+
+    void startMove();
+
+    /* Report the result of a completed iteration. The evaluation is relative to
+       the player to move. */
+    void iterationFinished(int depth, const Move &bestMove, Score eval);
+
+    bool mayStartIteration() const
+    {
+        return elapsedMS() < m_softLimitMS;
+    }
+    bool hardLimitReached(int elapsed) const
+    {
+        return elapsed >= m_hardLimitMS;
+    }
+
+    int elapsedMS() const;
+
+    // Progress of the thinking process in [0;1] for the progress bar.
+    float progress(int elapsed) const;
+
+private:
+    int m_maxMSecs;
+    int m_clockRemainingMSecs;
+    int m_clockIncrementMSecs;
+
+    struct timeval m_startTime; // time when move was started
+
+    int m_baseLimitMS; // soft limit before adaption
+    int m_softLimitMS;
+    int m_hardLimitMS;
+
+    float m_scale; // current adaption factor of the soft limit
+    int m_stableIterations;
+    Move m_lastBestMove;
+    Score m_lastEval;
+};
+
+#endif
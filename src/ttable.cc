@@ -16,9 +16,28 @@
   along with this program.  If not, see <http://www.gnu.org/licenses/>.
 ***************************************************************************/
 
+#include "config.h"
 #include "ttable.hh"
+#include "profile.hh"
 
 #include <iostream>
+#include <algorithm>
+#include <string.h>
+#include <stdint.h>
+#include <glib.h>
+
+#if HAVE_SYS_MMAN_H && HAVE_MMAP
+#define USE_MMAP 1
+#include <sys/mman.h>
+#else
+#define USE_MMAP 0
+#endif
+
+static const size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+
+// tables from this size on are cleared by several threads
+static const size_t PARALLEL_CLEAR_SIZE = 64 * 1024 * 1024;
+static const int MAX_CLEAR_THREADS = 16;
 
 // 16 -   65536
 // 17 -  131072
@@ -26,71 +45,212 @@
 // 19 -  524288
 // 20 - 1048576
 TranspositionTable::TranspositionTable(int nBits)
+    : TT(NULL),
+    m_mapping(NULL),
+    m_mappingSize(0),
+    m_hugePages(false)
+{
+    resize(nBits);
+}
+
+TranspositionTable::~TranspositionTable()
+{
+    release();
+}
+
+int TranspositionTable::bitsForSize(int megabytes)
 {
+    const long long bytes = (long long)megabytes * 1024 * 1024;
+
+    int nBits = MIN_BITS;
+    while (nBits < MAX_BITS && (long long)sizeof(TTEntry) << (nBits + 1) <= bytes) {
+        nBits++;
+    }
+
+    return nBits;
+}
+
+void TranspositionTable::resize(int nBits)
+{
+    release();
+
     tableSize = 1 << nBits;
+    mask = tableSize - 1;
+
+    allocate();
+
+    resetStats();
+
+    clear();
+}
+
+/* Large tables are mapped directly, preferably with explicit huge pages.
+   If none are reserved by the system, we ask for transparent huge pages.
+   Both reduce the TLB misses of the random table accesses. */
+void TranspositionTable::allocate()
+{
+    const size_t bytes = getSizeInBytes();
+
+    m_hugePages = false;
+    m_mapping = NULL;
+    m_mappingSize = 0;
+
+#if USE_MMAP
+    if (bytes >= HUGE_PAGE_SIZE) {
+        void *mem;
+
+#ifdef MAP_HUGETLB
+        mem = mmap(NULL, bytes, PROT_READ | PROT_WRITE,
+                         MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (mem != MAP_FAILED) {
+            m_mapping = mem;
+            m_mappingSize = bytes;
+            m_hugePages = true;
+            TT = (TTEntry *)mem;
+            return;
+        }
+#endif
+
+        // align the table to the huge-page size
+        const size_t size = bytes + HUGE_PAGE_SIZE;
+        mem = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (mem != MAP_FAILED) {
+            m_mapping = mem;
+            m_mappingSize = size;
+
+            uintptr_t aligned = ((uintptr_t)mem + HUGE_PAGE_SIZE - 1) & ~(uintptr_t)(HUGE_PAGE_SIZE - 1);
+            TT = (TTEntry *)aligned;
+
+#ifdef MADV_HUGEPAGE
+            m_hugePages = (madvise(TT, bytes, MADV_HUGEPAGE) == 0);
+#endif
+            return;
+        }
+    }
+#endif
+
     TT = new TTEntry[tableSize];
+}
 
-    mask = 0;
-    for (int i = 0; i < nBits; i++) {
-        mask <<= 1;
-        mask |= 1;
+void TranspositionTable::release()
+{
+#if USE_MMAP
+    if (m_mapping) {
+        munmap(m_mapping, m_mappingSize);
+        m_mapping = NULL;
+        TT = NULL;
     }
+#endif
 
-    hits = collisions = misses = 0;
+    delete[] TT;
+    TT = NULL;
+}
 
-    clear();
+struct ClearChunk
+{
+    char *start;
+    size_t size;
+};
+
+static gpointer clearChunk(gpointer data)
+{
+    ClearChunk *chunk = (ClearChunk *)data;
+    memset(chunk->start, 0, chunk->size);
+    return NULL;
 }
 
+/* Large tables are cleared in parallel. On a fresh table, this is also the first
+   access to the memory, such that the pages are distributed over the memory nodes
+   of the threads that touch them. */
 void TranspositionTable::clear()
 {
-    for (int i = 0; i < tableSize; i++) {
-        TT[i].key = 0;
+    const size_t bytes = getSizeInBytes();
+
+    int nThreads = 1;
+    if (bytes >= PARALLEL_CLEAR_SIZE) {
+        nThreads = std::min(int(g_get_num_processors()), MAX_CLEAR_THREADS);
     }
+
+    // split at page boundaries
+
+    const size_t chunkSize = (bytes / nThreads + HUGE_PAGE_SIZE - 1) & ~(HUGE_PAGE_SIZE - 1);
+
+    ClearChunk chunks[MAX_CLEAR_THREADS];
+    GThread *threads[MAX_CLEAR_THREADS];
+
+    for (int i = 0; i < nThreads; i++) {
+        const size_t start = std::min(bytes, i * chunkSize);
+        chunks[i].start = (char *)TT + start;
+        chunks[i].size = std::min(bytes - start, chunkSize);
+    }
+
+    for (int i = 1; i < nThreads; i++) {
+        threads[i] = g_thread_new(NULL, clearChunk, &chunks[i]);
+    }
+
+    clearChunk(&chunks[0]);
+
+    for (int i = 1; i < nThreads; i++) {
+        g_thread_join(threads[i]);
+    }
+
+    generation = 0;
 }
 
-TranspositionTable::~TranspositionTable()
+void TranspositionTable::newGeneration()
 {
-    delete[] TT;
+    generation++;
+
+    // an old entry would become valid again
+    if (generation == GENERATIONS) {
+        clear();
+    }
 }
 
 const TranspositionTable::TTEntry *TranspositionTable::search(Key key, const Board &b) const
 {
+    PROFILE(Prof_TTSearch);
+
     Key hashValue = key & mask;
 
+    // entries of older generations count as empty
+    const bool used = (TT[hashValue].key != 0 && isCurrent(TT[hashValue]));
+    const bool found = (used && TT[hashValue].key == key);
+
     lookups++;
-    if (TT[hashValue].key != 0) {
+    if (found) {
         hits++;
-    }
-    if (TT[hashValue].key != key) {
-        misses++;
+    } else if (used) {
+        collisions++;
     }
 
 #if SAFE_HASH
-    if (TT[hashValue].key == key && !(b == TT[hashValue].board)) {
+    if (found && !(b == TT[hashValue].board)) {
         std::cout << "HASH COLLISION\n";
         assert(0);
     }
 #endif
 
-    if (TT[hashValue].key == key) {
+    if (found) {
         return &TT[hashValue];
     } else {
         return NULL;
     }
 }
 
-void TranspositionTable::save(Key key, float value, Bound type, int depth, const Move &ttMove,
+void TranspositionTable::save(Key key, Score value, Bound type, int depth, const Move &ttMove,
                                 const Board &b)
 {
+    PROFILE(Prof_TTSave);
+
     Key hashValue = key & mask;
 
     bool replaceEntry = false;
-    /**/ if (TT[hashValue].key == 0) {
+    /**/ if (TT[hashValue].key == 0 || !isCurrent(TT[hashValue])) {
         replaceEntry = true;
     } else if (TT[hashValue].key != key) // collision
     {
         replaceEntry = true; /* Always replace such that irrelevant moves do not block the TT. */
-        collisions++;
     } else {
         if (depth > TT[hashValue].depth8) {
             replaceEntry = true;
@@ -103,7 +263,7 @@ void TranspositionTable::save(Key key, float value, Bound type, int depth, const
         TT[hashValue].key = key;
         TT[hashValue].value8 = value;
         TT[hashValue].depth8 = depth;
-        TT[hashValue].genBound8 = type;
+        TT[hashValue].genBound8 = (generation << BOUND_BITS) | type;
         TT[hashValue].ttMove = ttMove;
 
 #if SAFE_HASH
@@ -112,14 +272,18 @@ void TranspositionTable::save(Key key, float value, Bound type, int depth, const
     }
 }
 
-float TranspositionTable::getFillStatus() const
+float TranspositionTable::getFillStatus(int nSamples) const
 {
+    if (nSamples <= 0 || nSamples > tableSize) {
+        nSamples = tableSize;
+    }
+
     int nFilled = 0;
-    for (int i = 0; i < tableSize; i++) {
-        if (TT[i].key) {
+    for (int i = 0; i < nSamples; i++) {
+        if (TT[i].key && isCurrent(TT[i])) {
             nFilled++;
         }
     }
 
-    return float(nFilled) / tableSize;
+    return float(nFilled) / nSamples;
 }
@@ -20,6 +20,7 @@
 #define TTABLE_HH
 
 #include "board.hh"
+#include "score.hh"
 
 #define SAFE_HASH 0
 
@@ -29,8 +30,38 @@ public:
     TranspositionTable(int nBits);
     ~TranspositionTable();
 
+    enum { MIN_BITS = 10, MAX_BITS = 30 };
+
+    // Change the table size to 2^nBits entries. All entries are lost.
+    void resize(int nBits);
+
+    // The largest table size (in bits) that fits into the given memory.
+    static int bitsForSize(int megabytes);
+
+    int getNumEntries() const
+    {
+        return tableSize;
+    }
+
+    size_t getSizeInBytes() const
+    {
+        return size_t(tableSize) * sizeof(TTEntry);
+    }
+
+    // Whether the table is backed by huge pages (explicit or transparent).
+    bool usesHugePages() const
+    {
+        return m_hugePages;
+    }
+
     void clear();
 
+    /* Invalidate all entries without touching the table memory. The entries are tagged
+       with the generation in which they were saved, and entries from an older generation
+       are treated like empty ones. The generation counter is small, hence every
+       GENERATIONS-th call clears the table. */
+    void newGeneration();
+
     enum Bound : signed char
     {
         BOUND_LOWER,
@@ -41,9 +72,9 @@ public:
     struct TTEntry
     {
         Key key;
-        float value8;
+        short value8; // see score.hh
         signed char depth8; // depth to which this node was calculated
-        Bound genBound8;
+        unsigned char genBound8; // generation << BOUND_BITS | bound
         Move ttMove;
 
 #if SAFE_HASH
@@ -52,14 +83,31 @@ public:
 
         Bound getBoundType() const
         {
-            return (Bound)(genBound8);
+            return (Bound)(genBound8 & BOUND_MASK);
         }
     };
 
+    enum { BOUND_BITS = 2, BOUND_MASK = (1 << BOUND_BITS) - 1, GENERATIONS = 1 << (8 - BOUND_BITS) };
+
     const TTEntry *search(Key key, const Board &) const;
-    void save(Key key, float value, Bound type, int depth, const Move &bestMove, const Board &);
+    void save(Key key, Score value, Bound type, int depth, const Move &bestMove, const Board &);
+
+    // Like search(), but without verification against the board and not counted in the statistics.
+    const TTEntry *peek(Key key) const
+    {
+        const TTEntry &e = TT[key & mask];
+        return (e.key == key && isCurrent(e)) ? &e : NULL;
+    }
 
-    static inline Bound boundType(float value, float alpha, float beta)
+    // Start loading the entry for this key into the cache, so that a later search() does not stall.
+    void prefetch(Key key) const
+    {
+#ifdef __GNUC__
+        __builtin_prefetch(&TT[key & mask]);
+#endif
+    }
+
+    static inline Bound boundType(Score value, Score alpha, Score beta)
     {
         if (value <= alpha)
             return BOUND_UPPER;
@@ -71,32 +119,48 @@ public:
 
     void resetStats()
     {
-        lookups = hits = collisions = misses = 0;
+        lookups = hits = collisions = 0;
     }
 
-    int nHits() const
+    // lookups that found the position
+    long long nHits() const
     {
         return hits;
     }
 
-    int nCollisions() const
+    // lookups that found another position in the slot
+    long long nCollisions() const
     {
         return collisions;
     }
 
-    int nLookups() const
+    long long nLookups() const
     {
         return lookups;
     }
 
-    float getFillStatus() const;
+    // Fraction of used entries. Only the first nSamples entries are checked (all if zero).
+    float getFillStatus(int nSamples = 0) const;
 
 private:
     TTEntry *TT;
     int tableSize;
     Key mask;
+    unsigned char generation;
+
+    bool isCurrent(const TTEntry &e) const
+    {
+        return (e.genBound8 >> BOUND_BITS) == generation;
+    }
+
+    void *m_mapping; // NULL if allocated with new[]
+    size_t m_mappingSize;
+    bool m_hugePages;
+
+    void allocate();
+    void release();
 
-    mutable int lookups, hits, collisions, misses;
+    mutable long long lookups, hits, collisions;
 };
 
 typedef boost::shared_ptr<TranspositionTable> ttable_ptr;
@@ -81,6 +81,41 @@ private:
     short nElements;
 };
 
+/* Small pseudo-random number generator (xorshift64*). In contrast to rand(), it
+   generates the same sequence on all platforms and has no state that is shared
+   between threads.
+ */
+class RandomGenerator
+{
+public:
+    RandomGenerator(unsigned long long seed = 1)
+    {
+        setSeed(seed);
+    }
+
+    void setSeed(unsigned long long seed)
+    {
+        state = (seed ? seed : 0x9E3779B97F4A7C15ULL); // state must not be zero
+    }
+
+    unsigned long long next()
+    {
+        state ^= state >> 12;
+        state ^= state << 25;
+        state ^= state >> 27;
+        return state * 0x2545F4914F6CDD1DULL;
+    }
+
+    // random number in [0;n-1]
+    int nextInt(int n)
+    {
+        return (next() >> 32) % n;
+    }
+
+private:
+    unsigned long long state;
+};
+
 /* Simple 2D-vector for specifying graphics coordinates.
  */
 class Point2D
@@ -105,6 +140,42 @@ public:
 /* A position for pieces on the boards. */
 typedef short Position;
 
+/* A set of board positions, bit p corresponds to position p. */
+typedef unsigned long long PositionBits;
+
+inline PositionBits positionBit(int p)
+{
+    return PositionBits(1) << p;
+}
+
+// number of positions in the set
+inline int countPositions(PositionBits bits)
+{
+#ifdef __GNUC__
+    return __builtin_popcountll(bits);
+#else
+    int n = 0;
+    for (; bits; bits &= bits - 1)
+        n++;
+    return n;
+#endif
+}
+
+// the lowest position in a non-empty set
+inline int firstPosition(PositionBits bits)
+{
+#ifdef __GNUC__
+    return __builtin_ctzll(bits);
+#else
+    int p = 0;
+    while (!(bits & 1)) {
+        bits >>= 1;
+        p++;
+    }
+    return p;
+#endif
+}
+
 /* The player-identifier enum. */
 enum Player
 {